@@ -44,6 +44,9 @@
 /* Define if ALSA library is available. */
 #cmakedefine CONFIG_ALSA_MIDI @CONFIG_ALSA_MIDI@
 
+/* Define if ALSA UMP (MIDI 2.0) support is available. */
+#cmakedefine CONFIG_ALSA_UMP @CONFIG_ALSA_UMP@
+
 /* Define if JACK MIDI support is available. */
 #cmakedefine CONFIG_JACK_MIDI @CONFIG_JACK_MIDI@
 
@@ -46,14 +46,7 @@
 
 // Constructor.
 qmidinetApplication::qmidinetApplication ( int& argc, char **argv, bool bGUI )
-	: QObject(nullptr), m_pApp(nullptr), m_pIcon(nullptr)
-	#ifdef CONFIG_ALSA_MIDI	
-		, m_alsa(this)
-	#endif
-	#ifdef CONFIG_JACK_MIDI	
-		, m_jack(this)
-	#endif
-		, m_udpd(this)
+	: QObject(nullptr), m_pApp(nullptr), m_pIcon(nullptr), m_engine(this)
 	#ifdef CONFIG_XUNIQUE
 		, m_pMemory(nullptr)
 		, m_pServer(nullptr)
@@ -87,42 +80,26 @@ qmidinetApplication::qmidinetApplication ( int& argc, char **argv, bool bGUI )
 	m_pApp->setApplicationName(QMIDINET_TITLE);
 #endif
 
-#ifdef CONFIG_ALSA_MIDI
-	QObject::connect(
-		&m_udpd, SIGNAL(received(QByteArray, int)),
-		&m_alsa, SLOT(receive(QByteArray, int)));
-	QObject::connect(
-		&m_alsa, SIGNAL(received(QByteArray, int)),
-		&m_udpd, SLOT(receive(QByteArray, int)));
-#endif
-
-#ifdef CONFIG_JACK_MIDI
-	QObject::connect(
-		&m_udpd, SIGNAL(received(QByteArray, int)),
-		&m_jack, SLOT(receive(QByteArray, int)));
-	QObject::connect(
-		&m_jack, SIGNAL(received(QByteArray, int)),
-		&m_udpd, SLOT(receive(QByteArray, int)));
-	QObject::connect(&m_jack,
-		SIGNAL(shutdown()),
-		SLOT(shutdown()));
-#endif
-
 	if (m_pIcon) {
 		QObject::connect(
-			&m_udpd, SIGNAL(received(QByteArray, int)),
-			m_pIcon, SLOT(receiving()));
-	#ifdef CONFIG_ALSA_MIDI
-		QObject::connect(
-			&m_alsa, SIGNAL(received(QByteArray, int)),
+			&m_engine, SIGNAL(sending()),
 			m_pIcon, SLOT(sending()));
-	#endif
-	#ifdef CONFIG_JACK_MIDI
 		QObject::connect(
-			&m_jack, SIGNAL(received(QByteArray, int)),
-			m_pIcon, SLOT(sending()));
-	#endif
+			&m_engine, SIGNAL(receiving()),
+			m_pIcon, SLOT(receiving()));
 	}
+
+	QObject::connect(&m_engine,
+		SIGNAL(error(const QString&, const QString&)),
+		SLOT(message(const QString&, const QString&)));
+#ifdef CONFIG_JACK_MIDI
+	QObject::connect(&m_engine,
+		SIGNAL(shutdown()),
+		SLOT(shutdown()));
+	QObject::connect(&m_engine,
+		SIGNAL(reconnected()),
+		SLOT(reconnected()));
+#endif
 }
 
 
@@ -133,6 +110,8 @@ qmidinetApplication::~qmidinetApplication (void)
 	clearServer();
 #endif	// CONFIG_XUNIQUE
 
+	m_engine.close();
+
 	if (m_pIcon) delete m_pIcon;
 	if (m_pApp)  delete m_pApp;
 }
@@ -276,62 +255,7 @@ void qmidinetApplication::readyReadSlot (void)
 // Initializer (secondary).
 bool qmidinetApplication::setup (void)
 {
-	qmidinetOptions *pOptions = qmidinetOptions::getInstance();
-	if (pOptions == nullptr)
-		return false;
-
-	m_udpd.close();
-#ifdef CONFIG_JACK_MIDI	
-	m_jack.close();
-#endif
-#ifdef CONFIG_ALSA_MIDI
-	m_alsa.close();
-#endif
-
-#ifdef CONFIG_ALSA_MIDI
-	if (pOptions->bAlsaMidi
-		&& !m_alsa.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
-		message(tr("ALSA MIDI Inferface Error"),
-			tr("The ALSA MIDI interface could not be established.\n\n"
-			"Please, make sure you have a ALSA MIDI sub-system working "
-			"correctly and try again."));
-		return false;
-	}
-#endif
-
-#ifdef CONFIG_JACK_MIDI
-	if (pOptions->bJackMidi
-		&& !m_jack.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
-	#ifdef CONFIG_ALSA_MIDI
-		m_alsa.close();
-	#endif
-		message(tr("JACK MIDI Inferface Error"),
-			tr("The JACK MIDI interface could not be established.\n\n"
-			"Please, make sure you have a JACK MIDI sub-system working "
-			"correctly and try again."));
-		return false;
-	}
-#endif
-
-	if (!m_udpd.open(
-			pOptions->sInterface,
-			pOptions->sUdpAddr,
-			pOptions->iUdpPort,
-			pOptions->iNumPorts)) {
-	#ifdef CONFIG_ALSA_MIDI
-		m_alsa.close();
-	#endif
-	#ifdef CONFIG_JACK_MIDI
-		m_jack.close();
-	#endif
-		message(tr("Network Inferface Error"),
-			tr("The network interface could not be established.\n\n"
-			"Please, make sure you have an on-line network connection "
-			"and try again."));
-		return false;
-	}
-
-	return true;
+	return m_engine.setup(qmidinetOptions::getInstance());
 }
 
 
@@ -357,18 +281,33 @@ void qmidinetApplication::message (
 }
 
 
+// Runtime statistics (human readable).
+QString qmidinetApplication::statistics (void) const
+{
+	return m_engine.statistics();
+}
+
+
 #ifdef CONFIG_JACK_MIDI
 void qmidinetApplication::shutdown (void)
 {
-	m_jack.close();
-
 	message(tr("JACK MIDI Inferface Error"),
 		tr("The JACK MIDI interface has been shutdown.\n\n"
-		"Please, make sure you reactivate the JACK MIDI sub-system "
-		"and try again."));
+		"It will be reconnected as soon as the JACK MIDI sub-system "
+		"is reactivated."));
 
 	if (m_pIcon)
-		m_pIcon->show(false);
+		m_pIcon->show(false, false);
+}
+
+
+void qmidinetApplication::reconnected (void)
+{
+	message(tr("JACK MIDI Inferface"),
+		tr("The JACK MIDI interface has been reconnected."));
+
+	if (m_pIcon)
+		m_pIcon->show(true);
 }
 #endif
 
@@ -387,6 +326,7 @@ qmidinetSystemTrayIcon::qmidinetSystemTrayIcon ( qmidinetApplication *pApp )
 		tr("Options..."), this, SLOT(options()));
 	m_menu.addAction(QIcon(":/images/menuReset.png"),
 		tr("Reset"), this, SLOT(reset()));
+	m_menu.addAction(tr("Statistics..."), this, SLOT(statistics()));
 	m_menu.addSeparator();
 	m_menu.addAction(tr("About..."), this, SLOT(about()));
 	m_menu.addAction(tr("About Qt..."), m_pApp->app(), SLOT(aboutQt()));
@@ -404,7 +344,7 @@ qmidinetSystemTrayIcon::qmidinetSystemTrayIcon ( qmidinetApplication *pApp )
 
 
 // Initializer.
-void qmidinetSystemTrayIcon::show ( bool bSetup )
+void qmidinetSystemTrayIcon::show ( bool bSetup, bool bRestart )
 {
 	QPixmap pm(":/images/qmidinet.png");
 
@@ -418,7 +358,8 @@ void qmidinetSystemTrayIcon::show ( bool bSetup )
 			QPainter(&pm).drawPixmap(0, 0, pmError);
 		}
 		// Restart timeout (3 minutes)...
-		QTimer::singleShot(180000, this, SLOT(reset()));
+		if (bRestart)
+			QTimer::singleShot(180000, this, SLOT(reset()));
 	} else {
 		// Merge with the status overlay pixmaps...
 		if (m_iSending > 0) {
@@ -461,6 +402,18 @@ void qmidinetSystemTrayIcon::reset (void)
 }
 
 
+// Statistics dialog.
+void qmidinetSystemTrayIcon::statistics (void)
+{
+	QMessageBox sbox;
+	sbox.setWindowIcon(QSystemTrayIcon::icon());
+	sbox.setWindowTitle(tr("Statistics"));
+	sbox.setIcon(QMessageBox::Information);
+	sbox.setText(m_pApp->statistics());
+	sbox.exec();
+}
+
+
 // About dialog.
 void qmidinetSystemTrayIcon::about (void)
 {
@@ -22,10 +22,7 @@
 #ifndef __qmidinet_h
 #define __qmidinet_h
 
-#include "qmidinetUdpDevice.h"
-
-#include "qmidinetAlsaMidiDevice.h"
-#include "qmidinetJackMidiDevice.h"
+#include "qmidinetEngine.h"
 
 #include <QCoreApplication>
 
@@ -61,8 +58,8 @@ public:
 	// Initializers.
 	bool setup();
 
-	// Messager.
-	void message(const QString& sTitle, const QString& sText);
+	// Runtime statistics (human readable).
+	QString statistics() const;
 
 	// Simple accessor.
 	QCoreApplication *app() const { return m_pApp; }
@@ -77,8 +74,12 @@ public slots:
 	// Action slots...
 	void reset();
 
+	// Messager.
+	void message(const QString& sTitle, const QString& sText);
+
 #ifdef CONFIG_JACK_MIDI
 	void shutdown();
+	void reconnected();
 #endif
 
 #ifdef CONFIG_XUNIQUE
@@ -99,13 +100,8 @@ private:
 
 	qmidinetSystemTrayIcon *m_pIcon;
 
-#ifdef CONFIG_ALSA_MIDI
-	qmidinetAlsaMidiDevice m_alsa;
-#endif
-#ifdef CONFIG_JACK_MIDI
-	qmidinetJackMidiDevice m_jack;
-#endif
-	qmidinetUdpDevice m_udpd;
+	// The network bridge core.
+	qmidinetEngine m_engine;
 
 #ifdef CONFIG_XUNIQUE
 	QString        m_sUnique;
@@ -129,7 +125,7 @@ public:
 	qmidinetSystemTrayIcon(qmidinetApplication *pApp);
 
 	// Initializers.
-	void show(bool bSetup);
+	void show(bool bSetup, bool bRestart = true);
 
 	// Message bubble/dialog.
 	void message(const QString& sTitle, const QString& sText);
@@ -139,6 +135,7 @@ public slots:
 	// Action slots...
 	void options();
 	void reset();
+	void statistics();
 	void about();
 
 	// Handle system tray activity.
@@ -0,0 +1,382 @@
+// qmidinetAlsaMidiCodec.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetAlsaMidiCodec.h"
+
+#ifdef CONFIG_ALSA_MIDI
+
+
+//----------------------------------------------------------------------------
+// Raw MIDI to sequencer event translators (per event type).
+
+typedef bool (*qmidinetAlsaMidiCodec_encode_func) (
+	const unsigned char *data, unsigned short len, snd_seq_event_t *pEv);
+
+// Note on/off and key pressure.
+template <int Type>
+static bool qmidinetAlsaMidiCodec_encode_note (
+	const unsigned char *data, unsigned short, snd_seq_event_t *pEv )
+{
+	pEv->type = Type;
+	snd_seq_ev_set_fixed(pEv);
+	pEv->data.note.channel  = (data[0] & 0x0f);
+	pEv->data.note.note     = data[1];
+	pEv->data.note.velocity = data[2];
+	return true;
+}
+
+// Control change.
+template <int Type>
+static bool qmidinetAlsaMidiCodec_encode_control (
+	const unsigned char *data, unsigned short, snd_seq_event_t *pEv )
+{
+	pEv->type = Type;
+	snd_seq_ev_set_fixed(pEv);
+	pEv->data.control.channel = (data[0] & 0x0f);
+	pEv->data.control.param   = data[1];
+	pEv->data.control.value   = data[2];
+	return true;
+}
+
+// Program change, channel pressure, MTC quarter-frame and song select.
+template <int Type, bool Channel>
+static bool qmidinetAlsaMidiCodec_encode_value (
+	const unsigned char *data, unsigned short, snd_seq_event_t *pEv )
+{
+	pEv->type = Type;
+	snd_seq_ev_set_fixed(pEv);
+	pEv->data.control.channel = (Channel ? (data[0] & 0x0f) : 0);
+	pEv->data.control.value   = data[1];
+	return true;
+}
+
+// Pitch-bend and song position (14-bit, LSB first).
+template <int Type, bool Channel, int Offset>
+static bool qmidinetAlsaMidiCodec_encode_value14 (
+	const unsigned char *data, unsigned short, snd_seq_event_t *pEv )
+{
+	pEv->type = Type;
+	snd_seq_ev_set_fixed(pEv);
+	pEv->data.control.channel = (Channel ? (data[0] & 0x0f) : 0);
+	pEv->data.control.value   = ((int(data[2]) << 7) | int(data[1])) - Offset;
+	return true;
+}
+
+// Status only (system common and real-time).
+template <int Type>
+static bool qmidinetAlsaMidiCodec_encode_simple (
+	const unsigned char *, unsigned short, snd_seq_event_t *pEv )
+{
+	pEv->type = Type;
+	snd_seq_ev_set_fixed(pEv);
+	return true;
+}
+
+// System exclusive (referenced, not copied).
+static bool qmidinetAlsaMidiCodec_encode_sysex (
+	const unsigned char *data, unsigned short len, snd_seq_event_t *pEv )
+{
+	snd_seq_ev_set_sysex(pEv, len, (void *) data);
+	return true;
+}
+
+
+// Translator table entries (per status byte).
+struct qmidinetAlsaMidiCodec_encoder
+{
+	unsigned short size;
+	qmidinetAlsaMidiCodec_encode_func func;
+};
+
+// Channel messages (0x80-0xe0)...
+static const qmidinetAlsaMidiCodec_encoder g_channel_encoders[7] =
+{
+	{ 3, qmidinetAlsaMidiCodec_encode_note<SND_SEQ_EVENT_NOTEOFF> },
+	{ 3, qmidinetAlsaMidiCodec_encode_note<SND_SEQ_EVENT_NOTEON> },
+	{ 3, qmidinetAlsaMidiCodec_encode_note<SND_SEQ_EVENT_KEYPRESS> },
+	{ 3, qmidinetAlsaMidiCodec_encode_control<SND_SEQ_EVENT_CONTROLLER> },
+	{ 2, qmidinetAlsaMidiCodec_encode_value<SND_SEQ_EVENT_PGMCHANGE, true> },
+	{ 2, qmidinetAlsaMidiCodec_encode_value<SND_SEQ_EVENT_CHANPRESS, true> },
+	{ 3, qmidinetAlsaMidiCodec_encode_value14<SND_SEQ_EVENT_PITCHBEND, true, 8192> }
+};
+
+// System messages (0xf0-0xff)...
+static const qmidinetAlsaMidiCodec_encoder g_system_encoders[16] =
+{
+	{ 0, qmidinetAlsaMidiCodec_encode_sysex },
+	{ 2, qmidinetAlsaMidiCodec_encode_value<SND_SEQ_EVENT_QFRAME, false> },
+	{ 3, qmidinetAlsaMidiCodec_encode_value14<SND_SEQ_EVENT_SONGPOS, false, 0> },
+	{ 2, qmidinetAlsaMidiCodec_encode_value<SND_SEQ_EVENT_SONGSEL, false> },
+	{ 0, nullptr },	// 0xf4 (undefined)
+	{ 0, nullptr },	// 0xf5 (undefined)
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_TUNE_REQUEST> },
+	{ 0, qmidinetAlsaMidiCodec_encode_sysex },	// 0xf7 (end of SysEx)
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_CLOCK> },
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_TICK> },
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_START> },
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_CONTINUE> },
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_STOP> },
+	{ 0, nullptr },	// 0xfd (undefined)
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_SENSING> },
+	{ 1, qmidinetAlsaMidiCodec_encode_simple<SND_SEQ_EVENT_RESET> }
+};
+
+// Translator table lookup.
+static inline const qmidinetAlsaMidiCodec_encoder *qmidinetAlsaMidiCodec_encoder_of (
+	unsigned char status )
+{
+	if (status < 0x80)
+		return nullptr;
+	else
+	if (status < 0xf0)
+		return &g_channel_encoders[(status >> 4) - 0x08];
+	else
+		return &g_system_encoders[status & 0x0f];
+}
+
+
+//----------------------------------------------------------------------------
+// Sequencer event to raw MIDI translators (per event type).
+
+typedef unsigned short (*qmidinetAlsaMidiCodec_decode_func) (
+	const snd_seq_event_t *pEv, unsigned char *data);
+
+// Note on/off and key pressure.
+template <unsigned char Status>
+static unsigned short qmidinetAlsaMidiCodec_decode_note (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	data[0] = Status | (pEv->data.note.channel & 0x0f);
+	data[1] = (pEv->data.note.note & 0x7f);
+	data[2] = (pEv->data.note.velocity & 0x7f);
+	return 3;
+}
+
+// Control change.
+static unsigned short qmidinetAlsaMidiCodec_decode_cc (
+	unsigned char channel, unsigned int param, int value, unsigned char *data )
+{
+	data[0] = 0xb0 | (channel & 0x0f);
+	data[1] = (param & 0x7f);
+	data[2] = (value & 0x7f);
+	return 3;
+}
+
+static unsigned short qmidinetAlsaMidiCodec_decode_control (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	return qmidinetAlsaMidiCodec_decode_cc(
+		pEv->data.control.channel,
+		pEv->data.control.param,
+		pEv->data.control.value, data);
+}
+
+// 14-bit control change (MSB and LSB pair, for the lower 32).
+static unsigned short qmidinetAlsaMidiCodec_decode_control14 (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	const unsigned char channel = pEv->data.control.channel;
+	const unsigned int param = pEv->data.control.param;
+	const int value = pEv->data.control.value;
+	if (param >= 0x20)
+		return qmidinetAlsaMidiCodec_decode_cc(channel, param, value, data);
+	qmidinetAlsaMidiCodec_decode_cc(channel, param, value >> 7, data);
+	qmidinetAlsaMidiCodec_decode_cc(channel, param + 0x20, value, data + 3);
+	return 6;
+}
+
+// (Non-)Registered parameter numbers (MSB and LSB pairs).
+template <unsigned char ParamMSB, unsigned char ParamLSB>
+static unsigned short qmidinetAlsaMidiCodec_decode_param (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	const unsigned char channel = pEv->data.control.channel;
+	const unsigned int param = pEv->data.control.param;
+	const int value = pEv->data.control.value;
+	qmidinetAlsaMidiCodec_decode_cc(channel, ParamMSB, param >> 7, data);
+	qmidinetAlsaMidiCodec_decode_cc(channel, ParamLSB, param, data + 3);
+	qmidinetAlsaMidiCodec_decode_cc(channel, 0x06, value >> 7, data + 6);
+	qmidinetAlsaMidiCodec_decode_cc(channel, 0x26, value, data + 9);
+	return 12;
+}
+
+// Program change, channel pressure, MTC quarter-frame and song select.
+template <unsigned char Status, bool Channel>
+static unsigned short qmidinetAlsaMidiCodec_decode_value (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	data[0] = Status | (Channel ? (pEv->data.control.channel & 0x0f) : 0);
+	data[1] = (pEv->data.control.value & 0x7f);
+	return 2;
+}
+
+// Pitch-bend and song position (14-bit, LSB first).
+template <unsigned char Status, bool Channel, int Offset>
+static unsigned short qmidinetAlsaMidiCodec_decode_value14 (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	int value = pEv->data.control.value + Offset;
+	if (value < 0)
+		value = 0;
+	else
+	if (value > 0x3fff)
+		value = 0x3fff;
+	data[0] = Status | (Channel ? (pEv->data.control.channel & 0x0f) : 0);
+	data[1] = (value & 0x7f);
+	data[2] = (value >> 7) & 0x7f;
+	return 3;
+}
+
+// Status only (system common and real-time).
+template <unsigned char Status>
+static unsigned short qmidinetAlsaMidiCodec_decode_simple (
+	const snd_seq_event_t *, unsigned char *data )
+{
+	data[0] = Status;
+	return 1;
+}
+
+
+// Translator table (per event type).
+class qmidinetAlsaMidiCodec_decoders
+{
+public:
+
+	qmidinetAlsaMidiCodec_decoders ()
+	{
+		for (int i = 0; i < 256; ++i)
+			m_funcs[i] = nullptr;
+
+		m_funcs[SND_SEQ_EVENT_NOTEON]
+			= qmidinetAlsaMidiCodec_decode_note<0x90>;
+		m_funcs[SND_SEQ_EVENT_NOTEOFF]
+			= qmidinetAlsaMidiCodec_decode_note<0x80>;
+		m_funcs[SND_SEQ_EVENT_KEYPRESS]
+			= qmidinetAlsaMidiCodec_decode_note<0xa0>;
+		m_funcs[SND_SEQ_EVENT_CONTROLLER]
+			= qmidinetAlsaMidiCodec_decode_control;
+		m_funcs[SND_SEQ_EVENT_CONTROL14]
+			= qmidinetAlsaMidiCodec_decode_control14;
+		m_funcs[SND_SEQ_EVENT_NONREGPARAM]
+			= qmidinetAlsaMidiCodec_decode_param<0x63, 0x62>;
+		m_funcs[SND_SEQ_EVENT_REGPARAM]
+			= qmidinetAlsaMidiCodec_decode_param<0x65, 0x64>;
+		m_funcs[SND_SEQ_EVENT_PGMCHANGE]
+			= qmidinetAlsaMidiCodec_decode_value<0xc0, true>;
+		m_funcs[SND_SEQ_EVENT_CHANPRESS]
+			= qmidinetAlsaMidiCodec_decode_value<0xd0, true>;
+		m_funcs[SND_SEQ_EVENT_PITCHBEND]
+			= qmidinetAlsaMidiCodec_decode_value14<0xe0, true, 8192>;
+		m_funcs[SND_SEQ_EVENT_QFRAME]
+			= qmidinetAlsaMidiCodec_decode_value<0xf1, false>;
+		m_funcs[SND_SEQ_EVENT_SONGPOS]
+			= qmidinetAlsaMidiCodec_decode_value14<0xf2, false, 0>;
+		m_funcs[SND_SEQ_EVENT_SONGSEL]
+			= qmidinetAlsaMidiCodec_decode_value<0xf3, false>;
+		m_funcs[SND_SEQ_EVENT_TUNE_REQUEST]
+			= qmidinetAlsaMidiCodec_decode_simple<0xf6>;
+		m_funcs[SND_SEQ_EVENT_CLOCK]
+			= qmidinetAlsaMidiCodec_decode_simple<0xf8>;
+		m_funcs[SND_SEQ_EVENT_TICK]
+			= qmidinetAlsaMidiCodec_decode_simple<0xf9>;
+		m_funcs[SND_SEQ_EVENT_START]
+			= qmidinetAlsaMidiCodec_decode_simple<0xfa>;
+		m_funcs[SND_SEQ_EVENT_CONTINUE]
+			= qmidinetAlsaMidiCodec_decode_simple<0xfb>;
+		m_funcs[SND_SEQ_EVENT_STOP]
+			= qmidinetAlsaMidiCodec_decode_simple<0xfc>;
+		m_funcs[SND_SEQ_EVENT_SENSING]
+			= qmidinetAlsaMidiCodec_decode_simple<0xfe>;
+		m_funcs[SND_SEQ_EVENT_RESET]
+			= qmidinetAlsaMidiCodec_decode_simple<0xff>;
+	}
+
+	qmidinetAlsaMidiCodec_decode_func operator[] ( unsigned char type ) const
+		{ return m_funcs[type]; }
+
+private:
+
+	qmidinetAlsaMidiCodec_decode_func m_funcs[256];
+};
+
+static const qmidinetAlsaMidiCodec_decoders g_decoders;
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaMidiCodec -- Stateless sequencer event <-> raw MIDI codec.
+
+// Raw MIDI message size, from its status byte;
+// zero if undefined or variable-length (SysEx).
+unsigned short qmidinetAlsaMidiCodec::messageSize ( unsigned char status )
+{
+	const qmidinetAlsaMidiCodec_encoder *pEncoder
+		= qmidinetAlsaMidiCodec_encoder_of(status);
+	return (pEncoder ? pEncoder->size : 0);
+}
+
+
+// Complete raw MIDI message (status included) to sequencer event.
+bool qmidinetAlsaMidiCodec::encode (
+	const unsigned char *data, unsigned short len, snd_seq_event_t *pEv )
+{
+	if (len < 1)
+		return false;
+
+	// SysEx continuation (split across datagrams)...
+	if (data[0] < 0x80)
+		return qmidinetAlsaMidiCodec_encode_sysex(data, len, pEv);
+
+	const qmidinetAlsaMidiCodec_encoder *pEncoder
+		= qmidinetAlsaMidiCodec_encoder_of(data[0]);
+	if (pEncoder == nullptr || pEncoder->func == nullptr)
+		return false;
+	if (len < pEncoder->size)
+		return false;
+
+	return (*pEncoder->func)(data, len, pEv);
+}
+
+
+// Whether a sequencer event type translates to raw MIDI (SysEx too).
+bool qmidinetAlsaMidiCodec::isMidiEvent ( int type )
+{
+	if (type < 0 || type > 255)
+		return false;
+	else
+	if (type == SND_SEQ_EVENT_SYSEX)
+		return true;
+	else
+		return (g_decoders[(unsigned char) type] != nullptr);
+}
+
+
+// Sequencer event to raw MIDI bytes (SysEx excepted).
+unsigned short qmidinetAlsaMidiCodec::decode (
+	const snd_seq_event_t *pEv, unsigned char *data )
+{
+	const qmidinetAlsaMidiCodec_decode_func func = g_decoders[pEv->type];
+	return (func ? (*func)(pEv, data) : 0);
+}
+
+
+#endif	// CONFIG_ALSA_MIDI
+
+// end of qmidinetAlsaMidiCodec.cpp
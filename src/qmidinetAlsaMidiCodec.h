@@ -0,0 +1,71 @@
+// qmidinetAlsaMidiCodec.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetAlsaMidiCodec_h
+#define __qmidinetAlsaMidiCodec_h
+
+#include "qmidinetAbout.h"
+
+#ifdef CONFIG_ALSA_MIDI
+
+#include <alsa/asoundlib.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaMidiCodec -- Stateless sequencer event <-> raw MIDI codec.
+//
+// Table-driven, one translator per status byte (encode) or event type
+// (decode), each one specialised at compile time for its event type;
+// a replacement for snd_midi_event_encode/decode() on the hot path.
+
+class qmidinetAlsaMidiCodec
+{
+public:
+
+	// Maximum decoded size (a 14-bit (N)RPN, as four controllers).
+	static const unsigned short MaxDecodeSize = 12;
+
+	// Raw MIDI message size, from its status byte;
+	// zero if undefined or variable-length (SysEx).
+	static unsigned short messageSize(unsigned char status);
+
+	// Complete raw MIDI message (status included) to sequencer event;
+	// SysEx data is referenced, not copied, and its continuation chunks
+	// (leading data bytes, or 0xf7) are taken too. Event type, flags and
+	// data are set only; false if it has no sequencer event equivalent.
+	static bool encode(const unsigned char *data, unsigned short len,
+		snd_seq_event_t *pEv);
+
+	// Whether a sequencer event type translates to raw MIDI (SysEx too).
+	static bool isMidiEvent(int type);
+
+	// Sequencer event to raw MIDI bytes (at least MaxDecodeSize long);
+	// SysEx excepted. Returns the number of bytes (0 if none).
+	static unsigned short decode(const snd_seq_event_t *pEv,
+		unsigned char *data);
+};
+
+
+#endif	// CONFIG_ALSA_MIDI
+
+#endif	// __qmidinetAlsaMidiCodec_h
+
+// end of qmidinetAlsaMidiCodec.h
@@ -23,8 +23,16 @@
 
 #ifdef CONFIG_ALSA_MIDI
 
+#include "qmidinetAlsaMidiCodec.h"
+#include "qmidinetAlsaRawMidiDevice.h"
+#include "qmidinetUdpDevice.h"
+#include "qmidinetUdpPacket.h"
+
 #include <QThread>
 
+#include <string.h>
+
+
 //----------------------------------------------------------------------------
 // qmidinetAlsaMidiThread -- ALSA MIDI listener thread.
 //
@@ -85,18 +93,30 @@ void qmidinetAlsaMidiThread::run (void)
 	m_bRunState = true;
 	int iPoll = 0;
 
+	qmidinetAlsaMidiDevice *pAlsaMidiDevice
+		= qmidinetAlsaMidiDevice::getInstance();
+
 	while (m_bRunState && iPoll >= 0) {
 		// Wait for events...
 		iPoll = poll(pfds, nfds, 1000);
-		while (iPoll > 0) {
+		if (iPoll < 1)
+			continue;
+		// Fetch from the kernel just once (it's readable now),
+		// then drain what's buffered only, so that input never
+		// blocks (nor the output, shared) once it runs empty...
+		if (snd_seq_event_input_pending(m_pAlsaSeq, 1) < 1)
+			continue;
+		while (snd_seq_event_input_pending(m_pAlsaSeq, 0) > 0) {
 			snd_seq_event_t *pEv = nullptr;
-			snd_seq_event_input(m_pAlsaSeq, &pEv);
+			if (snd_seq_event_input(m_pAlsaSeq, &pEv) < 0)
+				break;
 			// Process input event - ...
 			// - enqueue to input track mapping;
-			qmidinetAlsaMidiDevice::getInstance()->capture(pEv);
+			pAlsaMidiDevice->capture(pEv);
 		//	snd_seq_free_event(pEv);
-			iPoll = snd_seq_event_input_pending(m_pAlsaSeq, 0);
 		}
+		// All batched datagrams go out per wakeup...
+		pAlsaMidiDevice->captureFlush();
 	}
 }
 
@@ -109,9 +129,13 @@ qmidinetAlsaMidiDevice *qmidinetAlsaMidiDevice::g_pDevice = nullptr;
 
 // Constructor.
 qmidinetAlsaMidiDevice::qmidinetAlsaMidiDevice ( QObject *pParent )
-	: QObject(pParent), m_nports(0), m_pAlsaSeq(nullptr),
+	: qmidinetMidiDevice(pParent), m_nports(0), m_pAlsaSeq(nullptr),
 		m_iAlsaClient(-1), m_piAlsaPort(nullptr),
-		m_ppAlsaEncoder(nullptr), m_pAlsaDecoder(nullptr),
+		m_pRunning(nullptr),
+		m_bFlush(false), m_iAlsaQueue(-1), m_playout_delay(0),
+		m_iEventFilter(FilterNone),
+		m_iWireFormat(qmidinetUdpPacket::Raw), m_pPackets(nullptr),
+		m_pBatchData(nullptr), m_pBatchLen(nullptr), m_nsent(0),
 		m_pRecvThread(nullptr)
 {
 	g_pDevice = this;
@@ -151,49 +175,77 @@ bool qmidinetAlsaMidiDevice::open ( const QString& sClientName, int iNumPorts )
 	snd_seq_set_client_name(m_pAlsaSeq, aClientName.constData());
 	m_iAlsaClient = snd_seq_client_id(m_pAlsaSeq);
 
+	// Only MIDI producing events (and not filtered out)
+	// are ever to be delivered, by the kernel proper...
+	for (i = 0; i < 256; ++i) {
+		if (isEventCaptured(i))
+			snd_seq_set_client_event_filter(m_pAlsaSeq, i);
+	}
+
+	// Make room for output bursts, so that these never block...
+	snd_seq_set_output_buffer_size(m_pAlsaSeq, 32 * 1024);
+	snd_seq_set_client_pool_output(m_pAlsaSeq, 2000);
+
 	m_nports = iNumPorts;
 
+	// Real-time queue, for input time-stamping and output playout...
+	m_iAlsaQueue = snd_seq_alloc_named_queue(
+		m_pAlsaSeq, aClientName.constData());
+	if (m_iAlsaQueue < 0) {
+		fprintf(stderr, "snd_seq_alloc_named_queue: %s\n",
+			snd_strerror(m_iAlsaQueue));
+	} else {
+		snd_seq_start_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
+		snd_seq_drain_output(m_pAlsaSeq);
+	}
+
 	// Create duplex ports.
 	m_piAlsaPort = new int [m_nports];
 
 	for (i = 0; i < m_nports; ++i)
 		m_piAlsaPort[i] = -1;
 
+	snd_seq_port_info_t *pPortInfo;
+	snd_seq_port_info_alloca(&pPortInfo);
+
 	const QString sPortName("port %1");
 	for (i = 0; i < m_nports; ++i) {
 		const QByteArray aPortName = sPortName.arg(i).toLocal8Bit();
-		int port = snd_seq_create_simple_port(
-			m_pAlsaSeq,	aPortName.constData(),
+		snd_seq_port_info_set_name(pPortInfo, aPortName.constData());
+		snd_seq_port_info_set_capability(pPortInfo,
 			SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE |
-			SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ,
+			SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ);
+		snd_seq_port_info_set_type(pPortInfo,
 			SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION);
-		if (port < 0) {
-			fprintf(stderr, "snd_seq_create_simple_port: %s\n", snd_strerror(port));
+		snd_seq_port_info_set_midi_channels(pPortInfo, 16);
+		// Captured events get (real-time) kernel time-stamps...
+		if (m_iAlsaQueue >= 0) {
+			snd_seq_port_info_set_timestamping(pPortInfo, 1);
+			snd_seq_port_info_set_timestamp_real(pPortInfo, 1);
+			snd_seq_port_info_set_timestamp_queue(pPortInfo, m_iAlsaQueue);
+		}
+		const int err = snd_seq_create_port(m_pAlsaSeq, pPortInfo);
+		if (err < 0) {
+			fprintf(stderr, "snd_seq_create_port: %s\n", snd_strerror(err));
 			return false;
 		}
-		m_piAlsaPort[i] = port;
+		m_piAlsaPort[i] = snd_seq_port_info_get_port(pPortInfo);
 	}
 
-	// Create MIDI (output) encoders.
-	m_ppAlsaEncoder = new snd_midi_event_t * [m_nports];
+	// Prepare the time-stamped datagrams...
+	m_pPackets = new qmidinetUdpPacketWriter [m_nports];
+	setWireFormat(m_iWireFormat);
 
+	// Prepare the raw datagrams...
+	m_pBatchData = new unsigned char [m_nports * qmidinetUdpPacket::MaxSize];
+	m_pBatchLen = new unsigned short [m_nports];
 	for (i = 0; i < m_nports; ++i)
-		m_ppAlsaEncoder[i] = nullptr;
-
-	for (i = 0; i < m_nports; ++i) {
-		long err = snd_midi_event_new(1024, &m_ppAlsaEncoder[i]);
-		if (err < 0) {
-			fprintf(stderr, "snd_midi_event_new: %s\n", snd_strerror(err));
-			return false;
-		}
-	}
+		m_pBatchLen[i] = 0;
 
-	// Create MIDI (input) decoders.
-	long err = snd_midi_event_new(1024, &m_pAlsaDecoder);
-	if (err < 0) {
-		fprintf(stderr, "snd_midi_event_new: %s\n", snd_strerror(err));
-		return false;
-	}
+	// Output running status (and SysEx) state.
+	m_pRunning = new unsigned char [m_nports];
+	for (i = 0; i < m_nports; ++i)
+		m_pRunning[i] = 0;
 
 	// Start listener thread...
 	m_pRecvThread = new qmidinetAlsaMidiThread(m_pAlsaSeq);
@@ -216,18 +268,9 @@ void qmidinetAlsaMidiDevice::close (void)
 		m_pRecvThread = nullptr;
 	}
 
-	if (m_pAlsaDecoder) {
-		snd_midi_event_free(m_pAlsaDecoder);
-		m_pAlsaDecoder = nullptr;
-	}
-
-	if (m_ppAlsaEncoder) {
-		for (int i = 0; i < m_nports; ++i) {
-			if (m_ppAlsaEncoder[i])
-				snd_midi_event_free(m_ppAlsaEncoder[i]);
-		}
-		delete [] m_ppAlsaEncoder;
-		m_ppAlsaEncoder = nullptr;
+	if (m_pRunning) {
+		delete [] m_pRunning;
+		m_pRunning = nullptr;
 	}
 
 	if (m_piAlsaPort) {
@@ -239,12 +282,37 @@ void qmidinetAlsaMidiDevice::close (void)
 		m_piAlsaPort = nullptr;
 	}
 
+	if (m_iAlsaQueue >= 0) {
+		snd_seq_stop_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
+		snd_seq_free_queue(m_pAlsaSeq, m_iAlsaQueue);
+		m_iAlsaQueue = -1;
+	}
+
 	if (m_pAlsaSeq) {
 		snd_seq_close(m_pAlsaSeq);
 		m_iAlsaClient = -1;
 		m_pAlsaSeq = nullptr;
 	}
 
+	m_bFlush = false;
+
+	if (m_pPackets) {
+		delete [] m_pPackets;
+		m_pPackets = nullptr;
+	}
+
+	if (m_pBatchData) {
+		delete [] m_pBatchData;
+		m_pBatchData = nullptr;
+	}
+
+	if (m_pBatchLen) {
+		delete [] m_pBatchLen;
+		m_pBatchLen = nullptr;
+	}
+
+	m_nsent = 0;
+
 	m_nports = 0;
 }
 
@@ -255,37 +323,10 @@ void qmidinetAlsaMidiDevice::capture ( snd_seq_event_t *pEv )
 	if (pEv == nullptr)
 		return;
 
-	// Ignore some events -- these are all ALSA internal
-	// events, which don't produce any MIDI bytes...
-	switch(pEv->type) {
-	case SND_SEQ_EVENT_OSS:
-	case SND_SEQ_EVENT_CLIENT_START:
-	case SND_SEQ_EVENT_CLIENT_EXIT:
-	case SND_SEQ_EVENT_CLIENT_CHANGE:
-	case SND_SEQ_EVENT_PORT_START:
-	case SND_SEQ_EVENT_PORT_EXIT:
-	case SND_SEQ_EVENT_PORT_CHANGE:
-	case SND_SEQ_EVENT_PORT_SUBSCRIBED:
-	case SND_SEQ_EVENT_PORT_UNSUBSCRIBED:
-	case SND_SEQ_EVENT_USR0:
-	case SND_SEQ_EVENT_USR1:
-	case SND_SEQ_EVENT_USR2:
-	case SND_SEQ_EVENT_USR3:
-	case SND_SEQ_EVENT_USR4:
-	case SND_SEQ_EVENT_USR5:
-	case SND_SEQ_EVENT_USR6:
-	case SND_SEQ_EVENT_USR7:
-	case SND_SEQ_EVENT_USR8:
-	case SND_SEQ_EVENT_USR9:
-	case SND_SEQ_EVENT_BOUNCE:
-	case SND_SEQ_EVENT_USR_VAR0:
-	case SND_SEQ_EVENT_USR_VAR1:
-	case SND_SEQ_EVENT_USR_VAR2:
-	case SND_SEQ_EVENT_USR_VAR3:
-	case SND_SEQ_EVENT_USR_VAR4:
-	case SND_SEQ_EVENT_NONE:
+	// Ignore all events which don't produce any MIDI bytes,
+	// or filtered out, in case the kernel hasn't already...
+	if (!isEventCaptured(pEv->type))
 		return;
-	}
 
 #ifdef CONFIG_DEBUG
 	// - show (input) event for debug purposes...
@@ -303,69 +344,266 @@ void qmidinetAlsaMidiDevice::capture ( snd_seq_event_t *pEv )
 	}
 #endif
 
+	// Kernel time-stamp (microseconds), if any...
+	unsigned long time = 0;
+	if ((pEv->flags & SND_SEQ_TIME_STAMP_MASK) == SND_SEQ_TIME_STAMP_REAL) {
+		time = (unsigned long) pEv->time.time.tv_sec * 1000000UL
+			+ (unsigned long) pEv->time.time.tv_nsec / 1000UL;
+	}
+
 	if (pEv->type == SND_SEQ_EVENT_SYSEX) {
 		unsigned char *data = (unsigned char *) pEv->data.ext.ptr;
-		recvData(data, pEv->data.ext.len, pEv->dest.port);
+		captureData(data, pEv->data.ext.len, pEv->dest.port, time);
 	} else {
 		// Decode ALSA event into raw bytes...
-		unsigned char data[1024];
-		long n = snd_midi_event_decode(m_pAlsaDecoder, data, sizeof(data), pEv);
+		unsigned char data[qmidinetAlsaMidiCodec::MaxDecodeSize];
+		const unsigned short n = qmidinetAlsaMidiCodec::decode(pEv, data);
 		if (n > 0)
-			recvData(data, n, pEv->dest.port);
-		else
-		if (n < 0)
-			fprintf(stderr, "snd_midi_event_decode: %s\n", snd_strerror(n));
-		snd_midi_event_reset_decode(m_pAlsaDecoder);
+			captureData(data, n, pEv->dest.port, time);
+	}
+}
+
+
+// Batched datagrams go out (per wakeup).
+void qmidinetAlsaMidiDevice::captureFlush (void)
+{
+	for (int i = 0; i < m_nports; ++i) {
+		if (m_pPackets)
+			packetFlush(i);
+		if (m_pBatchData)
+			batchFlush(i);
+	}
+
+	// Notify (once per wakeup)...
+	if (m_nsent > 0) {
+		m_nsent = 0;
+		emit sending();
 	}
 }
 
 
+// Captured data dispatch.
+void qmidinetAlsaMidiDevice::captureData ( const unsigned char *data,
+	unsigned short len, int port, unsigned long time )
+{
+	// Ports bridged through raw MIDI are left alone...
+	qmidinetAlsaRawMidiDevice *pAlsaRawMidiDevice
+		= qmidinetAlsaRawMidiDevice::getInstance();
+	if (pAlsaRawMidiDevice && pAlsaRawMidiDevice->isRawPort(port))
+		return;
+
+	if (m_pPackets && m_iWireFormat != qmidinetUdpPacket::Raw)
+		packetData(data, len, port, time);
+	else
+	if (m_pBatchData)
+		batchData(data, len, port);
+	else
+		recvData((unsigned char *) data, len, port);
+}
+
+
+// Time-stamped datagram assembly.
+void qmidinetAlsaMidiDevice::packetData (
+	const unsigned char *data, unsigned short len, int port, unsigned long time )
+{
+	if (port < 0 || port >= m_nports)
+		return;
+
+	qmidinetUdpPacketWriter& packet = m_pPackets[port];
+	if (packet.write(time, data, len))
+		return;
+
+	// Full, send it and start over...
+	packetFlush(port);
+
+	// Too big to fit, send it raw...
+	if (!packet.write(time, data, len))
+		recvData((unsigned char *) data, len, port);
+}
+
+
+void qmidinetAlsaMidiDevice::packetFlush ( int port )
+{
+	qmidinetUdpPacketWriter& packet = m_pPackets[port];
+	if (!packet.isEmpty()) {
+		recvData(packet.data(), packet.length(), port);
+		packet.clear();
+	}
+}
+
+
+// Raw datagram assembly.
+void qmidinetAlsaMidiDevice::batchData (
+	const unsigned char *data, unsigned short len, int port )
+{
+	if (port < 0 || port >= m_nports)
+		return;
+
+	if (m_pBatchLen[port] + len > qmidinetUdpPacket::MaxSize)
+		batchFlush(port);
+
+	// Too big to fit, send it alone...
+	if (len > qmidinetUdpPacket::MaxSize) {
+		recvData((unsigned char *) data, len, port);
+		return;
+	}
+
+	unsigned char *pBatch = m_pBatchData + port * qmidinetUdpPacket::MaxSize;
+	::memcpy(pBatch + m_pBatchLen[port], data, len);
+	m_pBatchLen[port] += len;
+}
+
+
+void qmidinetAlsaMidiDevice::batchFlush ( int port )
+{
+	if (m_pBatchLen[port] > 0) {
+		recvData(m_pBatchData + port * qmidinetUdpPacket::MaxSize,
+			m_pBatchLen[port], port);
+		m_pBatchLen[port] = 0;
+	}
+}
+
+
+// Network wire format accessors.
+void qmidinetAlsaMidiDevice::setWireFormat ( int iWireFormat )
+{
+	m_iWireFormat = iWireFormat;
+
+	// Time-stamped, or else UMP, datagrams...
+	for (int i = 0; m_pPackets && i < m_nports; ++i) {
+		m_pPackets[i].setFormat(
+			qmidinetUdpPacket::Format(m_iWireFormat), i);
+	}
+}
+
+int qmidinetAlsaMidiDevice::wireFormat (void) const
+{
+	return m_iWireFormat;
+}
+
+
 // Data transmission methods.
 bool qmidinetAlsaMidiDevice::sendData (
 	unsigned char *data, unsigned short len, int port ) const
+{
+	if (!outputData(data, len, port, true))
+		return false;
+
+	snd_seq_drain_output(m_pAlsaSeq);
+	return true;
+}
+
+
+// Encode raw MIDI bytes into (buffered) sequencer events;
+// a single complete message may also go direct, unbuffered.
+bool qmidinetAlsaMidiDevice::outputData ( const unsigned char *data,
+	unsigned short len, int port, bool bDirect, unsigned long usecs ) const
 {
 	if (port < 0 || port >= m_nports)
 		return false;
 
+	// Running status (or else, within SysEx)...
+	unsigned char& status = m_pRunning[port];
+	unsigned char running[3];
+
 	snd_seq_event_t ev;
-	unsigned char *d = data;
-	long l = len;
+	const unsigned char *d = data;
+	unsigned short l = len;
 	while (l > 0) {
+		// Split next complete message...
+		const unsigned char *m = d;
+		unsigned short size = 0;
+		unsigned short n = 1;
+		if (d[0] == 0xf0 || (status == 0xf0 && (d[0] < 0x80 || d[0] == 0xf7))) {
+			// SysEx (or else its continuation), up to its end...
+			if (d[0] != 0xf7) {
+				while (n < l && d[n] != 0xf7)
+					++n;
+				if (n < l)
+					++n;
+			}
+			status = (d[n - 1] == 0xf7 ? 0 : 0xf0);
+			size = n;
+		}
+		else
+		if (d[0] >= 0x80) {
+			// New status, then its data bytes...
+			size = qmidinetAlsaMidiCodec::messageSize(d[0]);
+			while (n < size && n < l && d[n] < 0x80)
+				++n;
+			if (d[0] < 0xf0)
+				status = d[0];
+			else
+			if (d[0] < 0xf8)
+				status = 0;
+			if (n < size)
+				size = 0; // Incomplete, skip it.
+		}
+		else
+		if (status >= 0x80) {
+			// Running status data bytes...
+			const unsigned short size1
+				= qmidinetAlsaMidiCodec::messageSize(status) - 1;
+			n = 0;
+			while (n < size1 && n < l && d[n] < 0x80)
+				++n;
+			if (n >= size1) {
+				running[0] = status;
+				::memcpy(&running[1], d, n);
+				m = running;
+				size = n + 1;
+			}
+		}
+		const bool bFirst = (d == data);
+		d += n;
+		l -= n;
+		// Undefined, incomplete or stray bytes are skipped...
+		if (size < 1)
+			continue;
 		snd_seq_event_t *pEv = &ev;
 		snd_seq_ev_clear(pEv);
+		if (!qmidinetAlsaMidiCodec::encode(m, size, pEv))
+			continue;
 		snd_seq_ev_set_source(pEv, m_piAlsaPort[port]);
 		snd_seq_ev_set_subs(pEv);
-		snd_seq_ev_set_direct(pEv);
-		long n = snd_midi_event_encode(m_ppAlsaEncoder[port], d, l, pEv);
-		if (n < 0) {
-			fprintf(stderr, "snd_midi_event_encode: %s\n", snd_strerror(n));
-			return false;
+		if (m_iAlsaQueue >= 0 && m_playout_delay > 0) {
+			// Schedule relative to now, plus the playout delay...
+			const unsigned long delay = 1000UL * m_playout_delay + usecs;
+			snd_seq_real_time_t rtime;
+			rtime.tv_sec  = delay / 1000000UL;
+			rtime.tv_nsec = 1000UL * (delay % 1000000UL);
+			snd_seq_ev_schedule_real(pEv, m_iAlsaQueue, 1, &rtime);
+		}
+		else snd_seq_ev_set_direct(pEv);
+	#ifdef CONFIG_DEBUG
+		// - show (output) event for debug purposes...
+		fprintf(stderr, "ALSA MIDI Out Port %d: 0x%02x", pEv->source.port, pEv->type);
+		if (pEv->type == SND_SEQ_EVENT_SYSEX) {
+			fprintf(stderr, " SysEx {");
+			unsigned char *data = (unsigned char *) pEv->data.ext.ptr;
+			for (unsigned int i = 0; i < pEv->data.ext.len; i++)
+				fprintf(stderr, " %02x", data[i]);
+			fprintf(stderr, " }\n");
+		} else {
+			for (unsigned int i = 0; i < sizeof(pEv->data.raw8.d); i++)
+				fprintf(stderr, " %3d", pEv->data.raw8.d[i]);
+			fprintf(stderr, "\n");
 		}
+	#endif
+		// The one and only message goes direct,
+		// unless it would overtake buffered ones...
+		int err;
+		if (bDirect && bFirst && l < 1
+			&& snd_seq_event_output_pending(m_pAlsaSeq) < 1)
+			err = snd_seq_event_output_direct(m_pAlsaSeq, pEv);
 		else
-		if (n > 0) {
-		#ifdef CONFIG_DEBUG
-			// - show (output) event for debug purposes...
-			fprintf(stderr, "ALSA MIDI Out Port %d: 0x%02x", pEv->source.port, pEv->type);
-			if (pEv->type == SND_SEQ_EVENT_SYSEX) {
-				fprintf(stderr, " SysEx {");
-				unsigned char *data = (unsigned char *) pEv->data.ext.ptr;
-				for (unsigned int i = 0; i < pEv->data.ext.len; i++)
-					fprintf(stderr, " %02x", data[i]);
-				fprintf(stderr, " }\n");
-			} else {
-				for (unsigned int i = 0; i < sizeof(pEv->data.raw8.d); i++)
-					fprintf(stderr, " %3d", pEv->data.raw8.d[i]);
-				fprintf(stderr, "\n");
-			}
-		#endif
-			snd_seq_event_output(m_pAlsaSeq, pEv);
-			l -= n;
-			d += n;
+			err = snd_seq_event_output(m_pAlsaSeq, pEv);
+		if (err < 0) {
+			fprintf(stderr, "snd_seq_event_output: %s\n", snd_strerror(err));
+			return false;
 		}
-		else break;
 	}
 
-	snd_seq_drain_output(m_pAlsaSeq);
 	return true;
 }
 
@@ -373,14 +611,113 @@ bool qmidinetAlsaMidiDevice::sendData (
 void qmidinetAlsaMidiDevice::recvData (
 	unsigned char *data, unsigned short len, int port )
 {
-	emit received(QByteArray((const char *) data, len), port);
+	// Send straight to the network, from this very thread...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice && pUdpDevice->sendData(data, len, port, this))
+		++m_nsent;
 }
 
 
 // Receive data slot.
 void qmidinetAlsaMidiDevice::receive ( QByteArray data, int port )
 {
-	sendData((unsigned char *) data.constData(), data.length(), port);
+	// Ports bridged through raw MIDI are left alone...
+	qmidinetAlsaRawMidiDevice *pAlsaRawMidiDevice
+		= qmidinetAlsaRawMidiDevice::getInstance();
+	if (pAlsaRawMidiDevice && pAlsaRawMidiDevice->isRawPort(port))
+		return;
+
+	qmidinetUdpPacketReader packet(
+		(const unsigned char *) data.constData(), data.length());
+
+	// Time-stamped events are delivered immediately, as they come,
+	// unless scheduled for playout, keeping their relative timing;
+	// a raw datagram of one single message may go direct...
+	bool bDirect = (packet.format() == qmidinetUdpPacket::Raw);
+	unsigned long usecs = 0;
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short len = 0;
+	while (packet.read(&delta, &pchData, &len)) {
+		usecs += delta;
+		outputData(pchData, len, port, bDirect && packet.atEnd(), usecs);
+		bDirect = false;
+	}
+
+	// Drain just once, after all pending datagrams...
+	if (!m_bFlush && m_pAlsaSeq
+		&& snd_seq_event_output_pending(m_pAlsaSeq) > 0) {
+		m_bFlush = true;
+		QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+	}
+}
+
+
+// Playout delay accessors (milliseconds; 0 = direct output).
+void qmidinetAlsaMidiDevice::setPlayoutDelay ( unsigned int playout_delay )
+{
+	m_playout_delay = playout_delay;
+}
+
+unsigned int qmidinetAlsaMidiDevice::playoutDelay (void) const
+{
+	return m_playout_delay;
+}
+
+
+// Captured event type filter accessors (effective on next open).
+void qmidinetAlsaMidiDevice::setEventFilter ( unsigned int iEventFilter )
+{
+	m_iEventFilter = iEventFilter;
+}
+
+unsigned int qmidinetAlsaMidiDevice::eventFilter (void) const
+{
+	return m_iEventFilter;
+}
+
+
+// Whether a sequencer event type gets captured.
+bool qmidinetAlsaMidiDevice::isEventCaptured ( int type ) const
+{
+	if (!qmidinetAlsaMidiCodec::isMidiEvent(type))
+		return false;
+
+	unsigned int iFilter = FilterNone;
+	switch (type) {
+	case SND_SEQ_EVENT_SENSING:
+		iFilter = FilterSensing;
+		break;
+	case SND_SEQ_EVENT_CLOCK:
+	case SND_SEQ_EVENT_TICK:
+		iFilter = FilterClock;
+		break;
+	case SND_SEQ_EVENT_START:
+	case SND_SEQ_EVENT_CONTINUE:
+	case SND_SEQ_EVENT_STOP:
+	case SND_SEQ_EVENT_SONGPOS:
+	case SND_SEQ_EVENT_SONGSEL:
+		iFilter = FilterTransport;
+		break;
+	case SND_SEQ_EVENT_QFRAME:
+		iFilter = FilterTimecode;
+		break;
+	case SND_SEQ_EVENT_SYSEX:
+		iFilter = FilterSysex;
+		break;
+	}
+
+	return ((m_iEventFilter & iFilter) == 0);
+}
+
+
+// Output drain slot.
+void qmidinetAlsaMidiDevice::flush (void)
+{
+	m_bFlush = false;
+
+	if (m_pAlsaSeq)
+		snd_seq_drain_output(m_pAlsaSeq);
 }
 
 
@@ -23,6 +23,7 @@
 #define __qmidinetAlsaMidiDevice_h
 
 #include "qmidinetAbout.h"
+#include "qmidinetMidiDevice.h"
 
 #ifdef CONFIG_ALSA_MIDI
 
@@ -38,7 +39,7 @@
 //----------------------------------------------------------------------------
 // qmidinetAlsaMidiDevice -- MIDI interface object.
 
-class qmidinetAlsaMidiDevice : public QObject
+class qmidinetAlsaMidiDevice : public qmidinetMidiDevice
 {
 	Q_OBJECT
 
@@ -59,23 +60,67 @@ public:
 	// Device termination method.
 	void close();
 
-	// MIDI event capture method.
+	// MIDI event capture methods.
 	void capture(snd_seq_event_t *pEv);
+	void captureFlush();
 
 	// Data transmission methods.
 	bool sendData(unsigned char *data, unsigned short len, int port = 0) const;
 	void recvData(unsigned char *data, unsigned short len, int port = 0);
 
-signals:
+	// Network wire format accessors.
+	void setWireFormat(int iWireFormat);
+	int wireFormat() const;
 
-	// Received data signal.
-	void received(QByteArray data, int port);
+	// Playout delay accessors (milliseconds; 0 = direct output).
+	void setPlayoutDelay(unsigned int playout_delay);
+	unsigned int playoutDelay() const;
+
+	// Captured event type filters (bit-mask).
+	enum EventFilter {
+		FilterNone      = 0x00,
+		FilterSensing   = 0x01,	// Active sensing.
+		FilterClock     = 0x02,	// Clock and tick.
+		FilterTransport = 0x04,	// Start, continue, stop, song position/select.
+		FilterTimecode  = 0x08,	// MTC quarter frame.
+		FilterSysex     = 0x10	// System exclusive.
+	};
+
+	// Captured event type filter accessors (effective on next open).
+	void setEventFilter(unsigned int iEventFilter);
+	unsigned int eventFilter() const;
+
+	// Whether a sequencer event type gets captured.
+	bool isEventCaptured(int type) const;
 
 public slots:
 
 	// Receive data slot.
 	void receive(QByteArray data, int port);
 
+	// Output drain slot.
+	void flush();
+
+protected:
+
+	// Captured data dispatch.
+	void captureData(const unsigned char *data, unsigned short len,
+		int port, unsigned long time);
+
+	// Time-stamped datagram assembly.
+	void packetData(const unsigned char *data, unsigned short len,
+		int port, unsigned long time);
+	void packetFlush(int port);
+
+	// Raw datagram assembly.
+	void batchData(const unsigned char *data, unsigned short len, int port);
+	void batchFlush(int port);
+
+	// Encode raw MIDI bytes into (buffered) sequencer events;
+	// a single complete message may also go direct, unbuffered.
+	bool outputData(const unsigned char *data, unsigned short len,
+		int port, bool bDirect, unsigned long usecs = 0) const;
+
 private:
 
 	// Instance variables,
@@ -86,8 +131,33 @@ private:
 	int  m_iAlsaClient;
 	int *m_piAlsaPort;
 
-	snd_midi_event_t **m_ppAlsaEncoder;
-	snd_midi_event_t  *m_pAlsaDecoder;
+	// Output running status, per port (0xf0 while within SysEx).
+	unsigned char *m_pRunning;
+
+	// Whether an output drain is pending.
+	bool m_bFlush;
+
+	// Time-stamping and playout queue.
+	int m_iAlsaQueue;
+
+	// Playout delay (milliseconds).
+	unsigned int m_playout_delay;
+
+	// Captured event type filter.
+	unsigned int m_iEventFilter;
+
+	// Network wire format.
+	int m_iWireFormat;
+
+	// Time-stamped datagrams (per port).
+	class qmidinetUdpPacketWriter *m_pPackets;
+
+	// Raw datagrams (per port, preallocated).
+	unsigned char  *m_pBatchData;
+	unsigned short *m_pBatchLen;
+
+	// Sent datagrams (per wakeup).
+	unsigned int m_nsent;
 
 	// Network receiver thread.
 	class qmidinetAlsaMidiThread *m_pRecvThread;
@@ -0,0 +1,496 @@
+// qmidinetAlsaRawMidiDevice.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetAlsaRawMidiDevice.h"
+
+#ifdef CONFIG_ALSA_MIDI
+
+#include "qmidinetUdpDevice.h"
+#include "qmidinetUdpPacket.h"
+
+#include <QThread>
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+
+// MIDI message size, from its status byte (SysEx excepted).
+static unsigned short qmidinetAlsaRawMidiDevice_status_size ( unsigned char status )
+{
+	switch (status & 0xf0) {
+	case 0xc0:
+	case 0xd0:
+		return 2;
+	case 0xf0:
+		switch (status) {
+		case 0xf1:
+		case 0xf3:
+			return 2;
+		case 0xf2:
+			return 3;
+		default:
+			return 1;
+		}
+	default:
+		return 3;
+	}
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaRawMidiThread -- ALSA raw MIDI listener thread.
+//
+
+class qmidinetAlsaRawMidiThread : public QThread
+{
+public:
+
+	// Constructor.
+	qmidinetAlsaRawMidiThread(snd_rawmidi_t **ppRawMidiIn, int nports);
+
+	// Run-state accessors.
+	void setRunState(bool bRunState);
+	bool runState() const;
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// The listener handles (per port).
+	snd_rawmidi_t **m_ppRawMidiIn;
+	int m_nports;
+
+	// Whether the thread is logically running.
+	volatile bool m_bRunState;
+};
+
+
+// Constructor.
+qmidinetAlsaRawMidiThread::qmidinetAlsaRawMidiThread (
+	snd_rawmidi_t **ppRawMidiIn, int nports )
+	: QThread(), m_ppRawMidiIn(ppRawMidiIn), m_nports(nports),
+		m_bRunState(false)
+{
+}
+
+
+// Run-state accessors.
+void qmidinetAlsaRawMidiThread::setRunState ( bool bRunState )
+{
+	m_bRunState = bRunState;
+}
+
+bool qmidinetAlsaRawMidiThread::runState (void) const
+{
+	return m_bRunState;
+}
+
+
+// The main thread executive.
+void qmidinetAlsaRawMidiThread::run (void)
+{
+	int i, nfds = 0;
+	for (i = 0; i < m_nports; ++i) {
+		if (m_ppRawMidiIn[i])
+			nfds += snd_rawmidi_poll_descriptors_count(m_ppRawMidiIn[i]);
+	}
+
+	if (nfds < 1)
+		return;
+
+	// All input descriptors, each one mapped to its port...
+	struct pollfd pfds[nfds];
+	int ports[nfds];
+	int n = 0;
+	for (i = 0; i < m_nports; ++i) {
+		if (m_ppRawMidiIn[i] == nullptr)
+			continue;
+		const int k = snd_rawmidi_poll_descriptors(
+			m_ppRawMidiIn[i], &pfds[n], nfds - n);
+		for (int j = 0; j < k; ++j)
+			ports[n++] = i;
+	}
+
+	m_bRunState = true;
+	int iPoll = 0;
+
+	qmidinetAlsaRawMidiDevice *pAlsaRawMidiDevice
+		= qmidinetAlsaRawMidiDevice::getInstance();
+
+	while (m_bRunState && iPoll >= 0) {
+		// Wait for hardware input...
+		iPoll = poll(pfds, n, 1000);
+		if (iPoll < 1)
+			continue;
+		for (i = 0; i < n; ++i) {
+			if (pfds[i].revents & POLLIN)
+				pAlsaRawMidiDevice->capture(ports[i]);
+		}
+		// All datagrams went out, notify once per wakeup...
+		pAlsaRawMidiDevice->captureFlush();
+	}
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaRawMidiDevice -- MIDI interface object (ALSA raw MIDI).
+//
+
+qmidinetAlsaRawMidiDevice *qmidinetAlsaRawMidiDevice::g_pDevice = nullptr;
+
+// Constructor.
+qmidinetAlsaRawMidiDevice::qmidinetAlsaRawMidiDevice ( QObject *pParent )
+	: qmidinetMidiDevice(pParent), m_nports(0),
+		m_ppRawMidiIn(nullptr), m_ppRawMidiOut(nullptr),
+		m_pFrames(nullptr), m_nsent(0), m_pRecvThread(nullptr)
+{
+	g_pDevice = this;
+}
+
+
+// Destructor.
+qmidinetAlsaRawMidiDevice::~qmidinetAlsaRawMidiDevice (void)
+{
+	close();
+
+	g_pDevice = nullptr;
+}
+
+
+// Kind of singleton reference.
+qmidinetAlsaRawMidiDevice *qmidinetAlsaRawMidiDevice::getInstance (void)
+{
+	return g_pDevice;
+}
+
+
+// Hardware device names accessors.
+void qmidinetAlsaRawMidiDevice::setDevices ( const QStringList& devices )
+{
+	m_devices = devices;
+}
+
+const QStringList& qmidinetAlsaRawMidiDevice::devices (void) const
+{
+	return m_devices;
+}
+
+
+// Device initialization method.
+bool qmidinetAlsaRawMidiDevice::open (
+	const QString& /*sClientName*/, int iNumPorts )
+{
+	// Close if already open.
+	close();
+
+	int i;
+
+	m_nports = iNumPorts;
+
+	m_ppRawMidiIn  = new snd_rawmidi_t * [m_nports];
+	m_ppRawMidiOut = new snd_rawmidi_t * [m_nports];
+
+	for (i = 0; i < m_nports; ++i) {
+		m_ppRawMidiIn[i]  = nullptr;
+		m_ppRawMidiOut[i] = nullptr;
+	}
+
+	m_pFrames = new Frame [m_nports];
+	::memset(m_pFrames, 0, m_nports * sizeof(Frame));
+
+	int nopen = 0;
+	for (i = 0; i < m_nports && i < m_devices.count(); ++i) {
+		const QString& sDevice = m_devices.at(i).trimmed();
+		if (sDevice.isEmpty())
+			continue;
+		const QByteArray aDevice = sDevice.toLocal8Bit();
+		const char *pszDevice = aDevice.constData();
+		// Duplex, or else either direction only...
+		int err = snd_rawmidi_open(&m_ppRawMidiIn[i], &m_ppRawMidiOut[i],
+			pszDevice, SND_RAWMIDI_NONBLOCK);
+		if (err < 0) {
+			m_ppRawMidiIn[i]  = nullptr;
+			m_ppRawMidiOut[i] = nullptr;
+			if (snd_rawmidi_open(&m_ppRawMidiIn[i], nullptr,
+					pszDevice, SND_RAWMIDI_NONBLOCK) < 0)
+				m_ppRawMidiIn[i] = nullptr;
+			if (snd_rawmidi_open(nullptr, &m_ppRawMidiOut[i],
+					pszDevice, SND_RAWMIDI_NONBLOCK) < 0)
+				m_ppRawMidiOut[i] = nullptr;
+		}
+		if (m_ppRawMidiIn[i] == nullptr && m_ppRawMidiOut[i] == nullptr) {
+			fprintf(stderr, "snd_rawmidi_open: %s: %s\n",
+				pszDevice, snd_strerror(err));
+			// Release the ones already open...
+			close();
+			return false;
+		}
+		++nopen;
+	}
+
+	// Start listener thread...
+	if (nopen > 0) {
+		m_pRecvThread = new qmidinetAlsaRawMidiThread(m_ppRawMidiIn, m_nports);
+		m_pRecvThread->start();
+	}
+
+	// Done.
+	return true;
+}
+
+
+// Device termination method.
+void qmidinetAlsaRawMidiDevice::close (void)
+{
+	if (m_pRecvThread) {
+		if (m_pRecvThread->isRunning()) do {
+			m_pRecvThread->setRunState(false);
+		//	m_pRecvThread->terminate();
+		} while	(!m_pRecvThread->wait(200));
+		delete m_pRecvThread;
+		m_pRecvThread = nullptr;
+	}
+
+	if (m_ppRawMidiIn) {
+		for (int i = 0; i < m_nports; ++i) {
+			if (m_ppRawMidiIn[i])
+				snd_rawmidi_close(m_ppRawMidiIn[i]);
+		}
+		delete [] m_ppRawMidiIn;
+		m_ppRawMidiIn = nullptr;
+	}
+
+	if (m_ppRawMidiOut) {
+		for (int i = 0; i < m_nports; ++i) {
+			if (m_ppRawMidiOut[i]) {
+				snd_rawmidi_drain(m_ppRawMidiOut[i]);
+				snd_rawmidi_close(m_ppRawMidiOut[i]);
+			}
+		}
+		delete [] m_ppRawMidiOut;
+		m_ppRawMidiOut = nullptr;
+	}
+
+	if (m_pFrames) {
+		delete [] m_pFrames;
+		m_pFrames = nullptr;
+	}
+
+	m_nports = 0;
+	m_nsent = 0;
+}
+
+
+// Whether a port is bridged through raw MIDI.
+bool qmidinetAlsaRawMidiDevice::isRawPort ( int port ) const
+{
+	if (port < 0 || port >= m_nports)
+		return false;
+
+	return (m_ppRawMidiIn && m_ppRawMidiIn[port])
+		|| (m_ppRawMidiOut && m_ppRawMidiOut[port]);
+}
+
+
+// MIDI data capture method (hardware input pending).
+void qmidinetAlsaRawMidiDevice::capture ( int port )
+{
+	if (port < 0 || port >= m_nports || m_ppRawMidiIn == nullptr)
+		return;
+
+	snd_rawmidi_t *pRawMidiIn = m_ppRawMidiIn[port];
+	if (pRawMidiIn == nullptr)
+		return;
+
+	// Read all there is, in chunks small enough to still fit
+	// in a datagram, once framed into complete messages...
+	unsigned char data[qmidinetUdpPacket::MaxSize / 2];
+	unsigned char buf[qmidinetUdpPacket::MaxSize];
+	for (;;) {
+		const ssize_t n = snd_rawmidi_read(pRawMidiIn, data, sizeof(data));
+		if (n > 0) {
+		#ifdef CONFIG_DEBUG
+			// - show (input) data for debug purposes...
+			fprintf(stderr, "ALSA RawMIDI In Port %d:", port);
+			for (ssize_t i = 0; i < n; ++i)
+				fprintf(stderr, " 0x%02x", data[i]);
+			fprintf(stderr, "\n");
+		#endif
+			const unsigned short len = frame(port, data, n, buf);
+			if (len > 0)
+				recvData(buf, len, port);
+		}
+		else {
+			if (n < 0 && n != -EAGAIN)
+				fprintf(stderr, "snd_rawmidi_read: %s\n", snd_strerror(n));
+			break;
+		}
+	}
+}
+
+
+// Frame raw input into complete messages: a message split across
+// reads goes whole with the later one, with its running status
+// restored; SysEx goes as it comes, the remainder of one left open
+// going first, as a continuation (see qmidinetUdpPacketReader).
+unsigned short qmidinetAlsaRawMidiDevice::frame ( int port,
+	const unsigned char *in, unsigned short len, unsigned char *data )
+{
+	Frame& f = m_pFrames[port];
+
+	unsigned short n = 0;
+
+	for (unsigned short i = 0; i < len; ++i) {
+		const unsigned char c = in[i];
+		// Real-time messages go through, anywhere...
+		if (c >= 0xf8) {
+			data[n++] = c;
+			continue;
+		}
+		// Within SysEx, up to its end...
+		if (f.sysex) {
+			if (c < 0x80 || c == 0xf7) {
+				data[n++] = c;
+				f.sysex = (c != 0xf7);
+				continue;
+			}
+			// Aborted by any other status...
+			f.sysex = false;
+		}
+		if (c == 0xf0) {
+			// SysEx begins...
+			data[n++] = c;
+			f.sysex = true;
+			f.status = 0;
+			f.nmsg = 0;
+			continue;
+		}
+		if (c == 0xf7)
+			continue; // Stray end of SysEx, skip it.
+		if (c >= 0x80) {
+			// New status (running, unless system common)...
+			f.msg[0] = c;
+			f.nmsg = 1;
+			f.status = (c < 0xf0 ? c : 0);
+		} else {
+			// Data bytes, on running status...
+			if (f.nmsg < 1) {
+				if (f.status < 0x80)
+					continue; // Stray data byte, skip it.
+				f.msg[0] = f.status;
+				f.nmsg = 1;
+			}
+			f.msg[f.nmsg++] = c;
+		}
+		// Complete message?
+		if (f.nmsg >= qmidinetAlsaRawMidiDevice_status_size(f.msg[0])) {
+			for (unsigned char j = 0; j < f.nmsg; ++j)
+				data[n++] = f.msg[j];
+			f.nmsg = 0;
+		}
+	}
+
+	return n;
+}
+
+
+// Notify (once per wakeup).
+void qmidinetAlsaRawMidiDevice::captureFlush (void)
+{
+	if (m_nsent > 0) {
+		m_nsent = 0;
+		emit sending();
+	}
+}
+
+
+// Data transmission methods.
+bool qmidinetAlsaRawMidiDevice::sendData (
+	unsigned char *data, unsigned short len, int port ) const
+{
+	if (port < 0 || port >= m_nports || m_ppRawMidiOut == nullptr)
+		return false;
+
+	snd_rawmidi_t *pRawMidiOut = m_ppRawMidiOut[port];
+	if (pRawMidiOut == nullptr)
+		return false;
+
+#ifdef CONFIG_DEBUG
+	// - show (output) data for debug purposes...
+	fprintf(stderr, "ALSA RawMIDI Out Port %d:", port);
+	for (unsigned short i = 0; i < len; ++i)
+		fprintf(stderr, " 0x%02x", data[i]);
+	fprintf(stderr, "\n");
+#endif
+
+	// Never blocks: whatever doesn't fit is lost...
+	const ssize_t n = snd_rawmidi_write(pRawMidiOut, data, len);
+	if (n < 0) {
+		fprintf(stderr, "snd_rawmidi_write: %s\n", snd_strerror(n));
+		return false;
+	}
+
+	return (n >= len);
+}
+
+
+void qmidinetAlsaRawMidiDevice::recvData (
+	unsigned char *data, unsigned short len, int port )
+{
+	// Send straight to the network, from this very thread...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice && pUdpDevice->sendData(data, len, port, this))
+		++m_nsent;
+}
+
+
+// Receive data slot.
+void qmidinetAlsaRawMidiDevice::receive ( QByteArray data, int port )
+{
+	if (!isRawPort(port))
+		return;
+
+	unsigned char *pchData = (unsigned char *) data.data();
+	const unsigned short len = data.length();
+
+	// Raw datagrams go straight to the wire...
+	if (qmidinetUdpPacket::format(pchData, len) == qmidinetUdpPacket::Raw) {
+		sendData(pchData, len, port);
+		return;
+	}
+
+	// Time-stamped ones are unpacked, as they come...
+	qmidinetUdpPacketReader packet(pchData, len);
+	unsigned long delta = 0;
+	const unsigned char *pchEvent = nullptr;
+	unsigned short nevent = 0;
+	while (packet.read(&delta, &pchEvent, &nevent))
+		sendData((unsigned char *) pchEvent, nevent, port);
+}
+
+
+#endif	// CONFIG_ALSA_MIDI
+
+// end of qmidinetAlsaRawMidiDevice.cpp
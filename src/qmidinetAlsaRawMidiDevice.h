@@ -0,0 +1,131 @@
+// qmidinetAlsaRawMidiDevice.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetAlsaRawMidiDevice_h
+#define __qmidinetAlsaRawMidiDevice_h
+
+#include "qmidinetAbout.h"
+#include "qmidinetMidiDevice.h"
+
+#ifdef CONFIG_ALSA_MIDI
+
+#include <alsa/asoundlib.h>
+
+#include <QObject>
+#include <QStringList>
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaRawMidiDevice -- MIDI interface object (ALSA raw MIDI).
+//
+// Hardware (eg. "hw:1,0,0") ports opened directly, moving raw bytes
+// to and from the network, with no sequencer event translation at all.
+
+class qmidinetAlsaRawMidiDevice : public qmidinetMidiDevice
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetAlsaRawMidiDevice(QObject *pParent = nullptr);
+
+	// Destructor.
+	~qmidinetAlsaRawMidiDevice();
+
+	// Kind of singleton reference.
+	static qmidinetAlsaRawMidiDevice *getInstance();
+
+	// Hardware device names accessors (one per port;
+	// empty names are left to the sequencer, as usual).
+	void setDevices(const QStringList& devices);
+	const QStringList& devices() const;
+
+	// Device initialization method.
+	bool open(const QString& sClientName, int iNumPorts = 1);
+
+	// Device termination method.
+	void close();
+
+	// Whether a port is bridged through raw MIDI.
+	bool isRawPort(int port) const;
+
+	// MIDI data capture methods.
+	void capture(int port);
+	void captureFlush();
+
+	// Data transmission methods.
+	bool sendData(unsigned char *data, unsigned short len, int port = 0) const;
+	void recvData(unsigned char *data, unsigned short len, int port = 0);
+
+public slots:
+
+	// Receive data slot.
+	void receive(QByteArray data, int port);
+
+protected:
+
+	// Frame raw input into complete messages (returns the number of
+	// bytes, at most 3/2 of the input plus a pending message's worth).
+	unsigned short frame(int port,
+		const unsigned char *in, unsigned short len, unsigned char *data);
+
+private:
+
+	// Instance variables,
+	int m_nports;
+
+	// Hardware device names (per port).
+	QStringList m_devices;
+
+	// Raw MIDI handles (per port).
+	snd_rawmidi_t **m_ppRawMidiIn;
+	snd_rawmidi_t **m_ppRawMidiOut;
+
+	// Raw MIDI input framing state (per port),
+	// carried across reads: running status,
+	// partial message and whether in SysEx.
+	struct Frame
+	{
+		unsigned char status;
+		unsigned char msg[3];
+		unsigned char nmsg;
+		bool          sysex;
+	};
+
+	Frame *m_pFrames;
+
+	// Sent datagrams (per wakeup).
+	unsigned int m_nsent;
+
+	// Hardware listener thread.
+	class qmidinetAlsaRawMidiThread *m_pRecvThread;
+
+	// Kind-of singleton reference.
+	static qmidinetAlsaRawMidiDevice *g_pDevice;
+};
+
+
+#endif	// CONFIG_ALSA_MIDI
+
+#endif	// __qmidinetAlsaRawMidiDevice_h
+
+// end of qmidinetAlsaRawMidiDevice.h
@@ -0,0 +1,563 @@
+// qmidinetAlsaUmpDevice.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetAlsaUmpDevice.h"
+
+#ifdef CONFIG_ALSA_UMP
+
+#include "qmidinetAlsaRawMidiDevice.h"
+#include "qmidinetUdpDevice.h"
+#include "qmidinetUdpPacket.h"
+#include "qmidinetUmp.h"
+
+#include <QThread>
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaUmpThread -- ALSA UMP listener thread.
+//
+
+class qmidinetAlsaUmpThread : public QThread
+{
+public:
+
+	// Constructor.
+	qmidinetAlsaUmpThread(snd_seq_t *pAlsaSeq);
+
+	// Run-state accessors.
+	void setRunState(bool bRunState);
+	bool runState() const;
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// The listener socket.
+	snd_seq_t *m_pAlsaSeq;
+
+	// Whether the thread is logically running.
+	volatile bool m_bRunState;
+};
+
+
+// Constructor.
+qmidinetAlsaUmpThread::qmidinetAlsaUmpThread ( snd_seq_t *pAlsaSeq )
+	: QThread(), m_pAlsaSeq(pAlsaSeq), m_bRunState(false)
+{
+}
+
+
+// Run-state accessors.
+void qmidinetAlsaUmpThread::setRunState ( bool bRunState )
+{
+	m_bRunState = bRunState;
+}
+
+bool qmidinetAlsaUmpThread::runState (void) const
+{
+	return m_bRunState;
+}
+
+
+// The main thread executive.
+void qmidinetAlsaUmpThread::run (void)
+{
+	const int nfds
+		= snd_seq_poll_descriptors_count(m_pAlsaSeq, POLLIN);
+	struct pollfd pfds[nfds];
+	snd_seq_poll_descriptors(m_pAlsaSeq, pfds, nfds, POLLIN);
+
+	m_bRunState = true;
+	int iPoll = 0;
+
+	qmidinetAlsaUmpDevice *pAlsaUmpDevice
+		= qmidinetAlsaUmpDevice::getInstance();
+
+	while (m_bRunState && iPoll >= 0) {
+		// Wait for events...
+		iPoll = poll(pfds, nfds, 1000);
+		if (iPoll < 1)
+			continue;
+		// Fetch from the kernel just once (it's readable now),
+		// then drain what's buffered only, never blocking...
+		if (snd_seq_event_input_pending(m_pAlsaSeq, 1) < 1)
+			continue;
+		while (snd_seq_event_input_pending(m_pAlsaSeq, 0) > 0) {
+			snd_seq_ump_event_t *pEv = nullptr;
+			if (snd_seq_ump_event_input(m_pAlsaSeq, &pEv) < 0)
+				break;
+			pAlsaUmpDevice->capture(pEv);
+		}
+		// All batched datagrams go out per wakeup...
+		pAlsaUmpDevice->captureFlush();
+	}
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaUmpDevice -- MIDI interface object (ALSA sequencer, UMP).
+//
+
+qmidinetAlsaUmpDevice *qmidinetAlsaUmpDevice::g_pDevice = nullptr;
+
+// Constructor.
+qmidinetAlsaUmpDevice::qmidinetAlsaUmpDevice ( QObject *pParent )
+	: qmidinetMidiDevice(pParent), m_nports(0), m_pAlsaSeq(nullptr),
+		m_iAlsaClient(-1), m_piAlsaPort(nullptr), m_iAlsaQueue(-1),
+		m_iWireFormat(qmidinetUdpPacket::Raw), m_pPackets(nullptr),
+		m_pBatchData(nullptr), m_pBatchLen(nullptr), m_nsent(0),
+		m_pRecvThread(nullptr)
+{
+	g_pDevice = this;
+}
+
+
+// Destructor.
+qmidinetAlsaUmpDevice::~qmidinetAlsaUmpDevice (void)
+{
+	close();
+
+	g_pDevice = nullptr;
+}
+
+
+// Kind of singleton reference.
+qmidinetAlsaUmpDevice *qmidinetAlsaUmpDevice::getInstance (void)
+{
+	return g_pDevice;
+}
+
+
+// Device initialization method.
+bool qmidinetAlsaUmpDevice::open ( const QString& sClientName, int iNumPorts )
+{
+	// Close if already open.
+	close();
+
+	// Open new ALSA sequencer client...
+	if (snd_seq_open(&m_pAlsaSeq, "hw", SND_SEQ_OPEN_DUPLEX, 0) < 0)
+		return false;
+
+	// Speak MIDI 2.0 (UMP) natively...
+	int err = snd_seq_set_client_midi_version(
+		m_pAlsaSeq, SND_SEQ_CLIENT_UMP_MIDI_2_0);
+	if (err < 0) {
+		fprintf(stderr, "snd_seq_set_client_midi_version: %s\n",
+			snd_strerror(err));
+		close();
+		return false;
+	}
+
+	int i;
+
+	// Set client identification...
+	const QByteArray aClientName = sClientName.toLocal8Bit();
+	snd_seq_set_client_name(m_pAlsaSeq, aClientName.constData());
+	m_iAlsaClient = snd_seq_client_id(m_pAlsaSeq);
+
+	// Make room for output bursts, so that these never block...
+	snd_seq_set_output_buffer_size(m_pAlsaSeq, 32 * 1024);
+	snd_seq_set_client_pool_output(m_pAlsaSeq, 2000);
+
+	m_nports = iNumPorts;
+
+	// Real-time queue, for input time-stamping...
+	m_iAlsaQueue = snd_seq_alloc_named_queue(
+		m_pAlsaSeq, aClientName.constData());
+	if (m_iAlsaQueue < 0) {
+		fprintf(stderr, "snd_seq_alloc_named_queue: %s\n",
+			snd_strerror(m_iAlsaQueue));
+	} else {
+		snd_seq_start_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
+		snd_seq_drain_output(m_pAlsaSeq);
+	}
+
+	// Create duplex ports, one UMP group each.
+	m_piAlsaPort = new int [m_nports];
+
+	for (i = 0; i < m_nports; ++i)
+		m_piAlsaPort[i] = -1;
+
+	snd_seq_port_info_t *pPortInfo;
+	snd_seq_port_info_alloca(&pPortInfo);
+
+	const QString sPortName("port %1");
+	for (i = 0; i < m_nports; ++i) {
+		const QByteArray aPortName = sPortName.arg(i).toLocal8Bit();
+		snd_seq_port_info_set_name(pPortInfo, aPortName.constData());
+		snd_seq_port_info_set_capability(pPortInfo,
+			SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE |
+			SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ);
+		snd_seq_port_info_set_type(pPortInfo,
+			SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_MIDI_UMP |
+			SND_SEQ_PORT_TYPE_APPLICATION);
+		snd_seq_port_info_set_midi_channels(pPortInfo, 16);
+		snd_seq_port_info_set_ump_group(pPortInfo, 1 + (i & 0x0f));
+		if (m_iAlsaQueue >= 0) {
+			snd_seq_port_info_set_timestamping(pPortInfo, 1);
+			snd_seq_port_info_set_timestamp_real(pPortInfo, 1);
+			snd_seq_port_info_set_timestamp_queue(pPortInfo, m_iAlsaQueue);
+		}
+		err = snd_seq_create_port(m_pAlsaSeq, pPortInfo);
+		if (err < 0) {
+			fprintf(stderr, "snd_seq_create_port: %s\n", snd_strerror(err));
+			close();
+			return false;
+		}
+		m_piAlsaPort[i] = snd_seq_port_info_get_port(pPortInfo);
+	}
+
+	// Prepare the time-stamped datagrams...
+	m_pPackets = new qmidinetUdpPacketWriter [m_nports];
+	setWireFormat(m_iWireFormat);
+
+	// Prepare the raw datagrams...
+	m_pBatchData = new unsigned char [m_nports * qmidinetUdpPacket::MaxSize];
+	m_pBatchLen = new unsigned short [m_nports];
+	for (i = 0; i < m_nports; ++i)
+		m_pBatchLen[i] = 0;
+
+	// Start listener thread...
+	m_pRecvThread = new qmidinetAlsaUmpThread(m_pAlsaSeq);
+	m_pRecvThread->start();
+
+	// Done.
+	return true;
+}
+
+
+// Device termination method.
+void qmidinetAlsaUmpDevice::close (void)
+{
+	if (m_pRecvThread) {
+		if (m_pRecvThread->isRunning()) do {
+			m_pRecvThread->setRunState(false);
+		//	m_pRecvThread->terminate();
+		} while	(!m_pRecvThread->wait(200));
+		delete m_pRecvThread;
+		m_pRecvThread = nullptr;
+	}
+
+	if (m_piAlsaPort) {
+		for (int i = 0; i < m_nports; ++i) {
+			if (m_piAlsaPort[i] >= 0)
+				snd_seq_delete_simple_port(m_pAlsaSeq, m_piAlsaPort[i]);
+		}
+		delete [] m_piAlsaPort;
+		m_piAlsaPort = nullptr;
+	}
+
+	if (m_iAlsaQueue >= 0) {
+		snd_seq_stop_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
+		snd_seq_free_queue(m_pAlsaSeq, m_iAlsaQueue);
+		m_iAlsaQueue = -1;
+	}
+
+	if (m_pAlsaSeq) {
+		snd_seq_close(m_pAlsaSeq);
+		m_iAlsaClient = -1;
+		m_pAlsaSeq = nullptr;
+	}
+
+	if (m_pPackets) {
+		delete [] m_pPackets;
+		m_pPackets = nullptr;
+	}
+
+	if (m_pBatchData) {
+		delete [] m_pBatchData;
+		m_pBatchData = nullptr;
+	}
+
+	if (m_pBatchLen) {
+		delete [] m_pBatchLen;
+		m_pBatchLen = nullptr;
+	}
+
+	m_nports = 0;
+	m_nsent = 0;
+}
+
+
+// MIDI event capture method.
+void qmidinetAlsaUmpDevice::capture ( snd_seq_ump_event_t *pEv )
+{
+	if (pEv == nullptr)
+		return;
+
+	// Only UMP events (the kernel converts legacy ones)...
+	if (!snd_seq_ev_is_ump(pEv))
+		return;
+
+	int port = -1;
+	for (int i = 0; i < m_nports; ++i) {
+		if (m_piAlsaPort[i] == pEv->dest.port) {
+			port = i;
+			break;
+		}
+	}
+
+	if (port < 0)
+		return;
+
+#ifdef CONFIG_DEBUG
+	// - show (input) event for debug purposes...
+	fprintf(stderr, "ALSA UMP In Port %d:", port);
+	const unsigned short nwords = qmidinetUmp::packetSize(pEv->ump[0]);
+	for (unsigned short i = 0; i < nwords; ++i)
+		fprintf(stderr, " %08x", pEv->ump[i]);
+	fprintf(stderr, "\n");
+#endif
+
+	// Kernel time-stamp (microseconds), if any...
+	unsigned long time = 0;
+	if ((pEv->flags & SND_SEQ_TIME_STAMP_MASK) == SND_SEQ_TIME_STAMP_REAL) {
+		time = (unsigned long) pEv->time.time.tv_sec * 1000000UL
+			+ (unsigned long) pEv->time.time.tv_nsec / 1000UL;
+	}
+
+	// UMP datagrams take the packets, as they are...
+	if (m_iWireFormat == qmidinetUdpPacket::Ump && !isRawPort(port)) {
+		const unsigned short nwords = qmidinetUmp::packetSize(pEv->ump[0]);
+		qmidinetUdpPacketWriter& packet = m_pPackets[port];
+		if (packet.writeUmp(pEv->ump, nwords))
+			return;
+		// Full, send it and start over...
+		batchFlush(port);
+		if (packet.writeUmp(pEv->ump, nwords))
+			return;
+	}
+
+	// Otherwise translate to MIDI 1.0, at the network edge...
+	unsigned char data[qmidinetUmp::MaxDecodeSize];
+	const unsigned short n = qmidinetUmp::decode(pEv->ump, data);
+	if (n > 0)
+		captureData(data, n, port, time);
+}
+
+
+// Batched datagrams go out (per wakeup).
+void qmidinetAlsaUmpDevice::captureFlush (void)
+{
+	for (int i = 0; i < m_nports; ++i)
+		batchFlush(i);
+
+	// Notify (once per wakeup)...
+	if (m_nsent > 0) {
+		m_nsent = 0;
+		emit sending();
+	}
+}
+
+
+// Captured data dispatch.
+void qmidinetAlsaUmpDevice::captureData ( const unsigned char *data,
+	unsigned short len, int port, unsigned long time )
+{
+	// Ports bridged through raw MIDI are left alone...
+	if (isRawPort(port))
+		return;
+
+	if (m_iWireFormat != qmidinetUdpPacket::Raw) {
+		qmidinetUdpPacketWriter& packet = m_pPackets[port];
+		if (packet.write(time, data, len))
+			return;
+		// Full, send it and start over...
+		batchFlush(port);
+		if (!packet.write(time, data, len))
+			recvData((unsigned char *) data, len, port);
+	} else {
+		if (m_pBatchLen[port] + len > qmidinetUdpPacket::MaxSize)
+			batchFlush(port);
+		unsigned char *pBatch
+			= m_pBatchData + port * qmidinetUdpPacket::MaxSize;
+		::memcpy(pBatch + m_pBatchLen[port], data, len);
+		m_pBatchLen[port] += len;
+	}
+}
+
+
+// Whether a port is bridged through raw MIDI instead.
+bool qmidinetAlsaUmpDevice::isRawPort ( int port ) const
+{
+	qmidinetAlsaRawMidiDevice *pAlsaRawMidiDevice
+		= qmidinetAlsaRawMidiDevice::getInstance();
+	return (pAlsaRawMidiDevice && pAlsaRawMidiDevice->isRawPort(port));
+}
+
+
+// Captured datagrams (raw, time-stamped or UMP) go out.
+void qmidinetAlsaUmpDevice::batchFlush ( int port )
+{
+	qmidinetUdpPacketWriter& packet = m_pPackets[port];
+	if (!packet.isEmpty()) {
+		recvData(packet.data(), packet.length(), port);
+		packet.clear();
+	}
+
+	if (m_pBatchLen[port] > 0) {
+		recvData(m_pBatchData + port * qmidinetUdpPacket::MaxSize,
+			m_pBatchLen[port], port);
+		m_pBatchLen[port] = 0;
+	}
+}
+
+
+// Network wire format accessors.
+void qmidinetAlsaUmpDevice::setWireFormat ( int iWireFormat )
+{
+	m_iWireFormat = iWireFormat;
+
+	// Time-stamped, or else UMP, datagrams...
+	for (int i = 0; m_pPackets && i < m_nports; ++i) {
+		m_pPackets[i].setFormat(
+			qmidinetUdpPacket::Format(m_iWireFormat), i);
+	}
+}
+
+int qmidinetAlsaUmpDevice::wireFormat (void) const
+{
+	return m_iWireFormat;
+}
+
+
+// Data transmission methods.
+bool qmidinetAlsaUmpDevice::sendData (
+	unsigned char *data, unsigned short len, int port ) const
+{
+	if (!outputData(data, len, port))
+		return false;
+
+	snd_seq_drain_output(m_pAlsaSeq);
+	return true;
+}
+
+
+void qmidinetAlsaUmpDevice::recvData (
+	unsigned char *data, unsigned short len, int port )
+{
+	// Send straight to the network, from this very thread...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice && pUdpDevice->sendData(data, len, port, this))
+		++m_nsent;
+}
+
+
+// Encode one MIDI 1.0 message into (buffered) UMP events.
+bool qmidinetAlsaUmpDevice::outputData (
+	const unsigned char *data, unsigned short len, int port ) const
+{
+	if (port < 0 || port >= m_nports || m_pAlsaSeq == nullptr)
+		return false;
+
+	// One packet at a time...
+	unsigned int ump[qmidinetUmp::MaxWords];
+	unsigned short i = 0;
+	while (i < len) {
+		unsigned short n = 0;
+		const unsigned short nwords
+			= qmidinetUmp::encodeNext(data + i, len - i, port, ump, &n);
+		if (nwords > 0 && !outputUmp(ump, nwords, port))
+			return false;
+		i += n;
+	}
+
+	return true;
+}
+
+
+// Output UMP packets, as they are (buffered).
+bool qmidinetAlsaUmpDevice::outputUmp (
+	const unsigned int *ump, unsigned short nwords, int port ) const
+{
+	if (port < 0 || port >= m_nports || m_pAlsaSeq == nullptr)
+		return false;
+
+	snd_seq_ump_event_t ev;
+	unsigned short i = 0;
+	while (i < nwords) {
+		const unsigned short nsize = qmidinetUmp::packetSize(ump[i]);
+		if (i + nsize > nwords)
+			break;
+		snd_seq_ump_event_t *pEv = &ev;
+		::memset(pEv, 0, sizeof(ev));
+		pEv->flags = SND_SEQ_EVENT_UMP;
+		::memcpy(pEv->ump, &ump[i], nsize * sizeof(unsigned int));
+		snd_seq_ev_set_source(pEv, m_piAlsaPort[port]);
+		snd_seq_ev_set_subs(pEv);
+		snd_seq_ev_set_direct(pEv);
+	#ifdef CONFIG_DEBUG
+		// - show (output) event for debug purposes...
+		fprintf(stderr, "ALSA UMP Out Port %d:", port);
+		for (unsigned short j = 0; j < nsize; ++j)
+			fprintf(stderr, " %08x", pEv->ump[j]);
+		fprintf(stderr, "\n");
+	#endif
+		const int err = snd_seq_ump_event_output(m_pAlsaSeq, pEv);
+		if (err < 0) {
+			fprintf(stderr, "snd_seq_ump_event_output: %s\n", snd_strerror(err));
+			return false;
+		}
+		i += nsize;
+	}
+
+	return true;
+}
+
+
+// Receive data slot.
+void qmidinetAlsaUmpDevice::receive ( QByteArray data, int port )
+{
+	// Ports bridged through raw MIDI are left alone...
+	if (isRawPort(port))
+		return;
+
+	qmidinetUdpPacketReader packet(
+		(const unsigned char *) data.constData(), data.length());
+	if (packet.format() == qmidinetUdpPacket::Ump) {
+		// UMP packets go out as they are, fixed-stride...
+		unsigned int ump[qmidinetUmp::MaxWords];
+		unsigned short nwords = 0;
+		while (packet.readUmp(ump, &nwords))
+			outputUmp(ump, nwords, port);
+	} else {
+		// Split into single messages, each one into UMP...
+		unsigned long delta = 0;
+		const unsigned char *pchData = nullptr;
+		unsigned short len = 0;
+		while (packet.read(&delta, &pchData, &len))
+			outputData(pchData, len, port);
+	}
+
+	// Drain just once, per datagram...
+	if (m_pAlsaSeq && snd_seq_event_output_pending(m_pAlsaSeq) > 0)
+		snd_seq_drain_output(m_pAlsaSeq);
+}
+
+
+#endif	// CONFIG_ALSA_UMP
+
+// end of qmidinetAlsaUmpDevice.cpp
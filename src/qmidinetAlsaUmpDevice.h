@@ -0,0 +1,139 @@
+// qmidinetAlsaUmpDevice.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetAlsaUmpDevice_h
+#define __qmidinetAlsaUmpDevice_h
+
+#include "qmidinetAbout.h"
+#include "qmidinetMidiDevice.h"
+
+#ifdef CONFIG_ALSA_UMP
+
+#include <alsa/asoundlib.h>
+
+#include <QObject>
+#include <QString>
+
+
+//----------------------------------------------------------------------------
+// qmidinetAlsaUmpDevice -- MIDI interface object (ALSA sequencer, UMP).
+//
+// A MIDI 2.0 sequencer client: events come and go as Universal MIDI
+// Packets (fixed-size 32-bit words); these go on the wire as they are,
+// in UMP datagrams, or else translated to and from MIDI 1.0 bytes.
+
+class qmidinetAlsaUmpDevice : public qmidinetMidiDevice
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetAlsaUmpDevice(QObject *pParent = nullptr);
+
+	// Destructor.
+	~qmidinetAlsaUmpDevice();
+
+	// Kind of singleton reference.
+	static qmidinetAlsaUmpDevice *getInstance();
+
+	// Device initialization method.
+	bool open(const QString& sClientName, int iNumPorts = 1);
+
+	// Device termination method.
+	void close();
+
+	// MIDI event capture methods.
+	void capture(snd_seq_ump_event_t *pEv);
+	void captureFlush();
+
+	// Data transmission methods.
+	bool sendData(unsigned char *data, unsigned short len, int port = 0) const;
+	void recvData(unsigned char *data, unsigned short len, int port = 0);
+
+	// Network wire format accessors.
+	void setWireFormat(int iWireFormat);
+	int wireFormat() const;
+
+public slots:
+
+	// Receive data slot.
+	void receive(QByteArray data, int port);
+
+protected:
+
+	// Captured data dispatch.
+	void captureData(const unsigned char *data, unsigned short len,
+		int port, unsigned long time);
+
+	// Captured datagrams (raw, time-stamped or UMP) go out.
+	void batchFlush(int port);
+
+	// Whether a port is bridged through raw MIDI instead.
+	bool isRawPort(int port) const;
+
+	// Encode one MIDI 1.0 message into (buffered) UMP events.
+	bool outputData(const unsigned char *data, unsigned short len,
+		int port) const;
+
+	// Output UMP packets, as they are (buffered).
+	bool outputUmp(const unsigned int *ump, unsigned short nwords,
+		int port) const;
+
+private:
+
+	// Instance variables,
+	int m_nports;
+
+	// Instance variables.
+	snd_seq_t *m_pAlsaSeq;
+	int  m_iAlsaClient;
+	int *m_piAlsaPort;
+
+	// Time-stamping queue.
+	int m_iAlsaQueue;
+
+	// Network wire format.
+	int m_iWireFormat;
+
+	// Time-stamped datagrams (per port).
+	class qmidinetUdpPacketWriter *m_pPackets;
+
+	// Raw datagrams (per port, preallocated).
+	unsigned char  *m_pBatchData;
+	unsigned short *m_pBatchLen;
+
+	// Sent datagrams (per wakeup).
+	unsigned int m_nsent;
+
+	// Network receiver thread.
+	class qmidinetAlsaUmpThread *m_pRecvThread;
+
+	// Kind-of singleton reference.
+	static qmidinetAlsaUmpDevice *g_pDevice;
+};
+
+
+#endif	// CONFIG_ALSA_UMP
+
+#endif	// __qmidinetAlsaUmpDevice_h
+
+// end of qmidinetAlsaUmpDevice.h
@@ -0,0 +1,181 @@
+// qmidinetDedup.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetDedup.h"
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetDedup -- Duplicate and echo suppression (merge stage).
+
+// Constructor.
+qmidinetDedup::qmidinetDedup (void) : m_window(0), m_bDuplicates(false)
+{
+	::memset(m_table, 0, sizeof(m_table));
+}
+
+
+// Hash table (re)initializer.
+void qmidinetDedup::setup ( int iWindow, bool bDuplicates )
+{
+	QMutexLocker locker(&m_mutex);
+
+	::memset(m_table, 0, sizeof(m_table));
+
+	const unsigned int window = (iWindow > 0 ? 1000 * iWindow : 0);
+
+	m_bDuplicates = bDuplicates;
+
+	m_timer.start();
+
+	// Start all stale...
+	const unsigned int t0 = now() - window - 1;
+	for (int i = 0; i < TableSize; ++i)
+		m_table[i].time = t0;
+
+	m_window.store(window);
+}
+
+
+// Hash table terminator.
+void qmidinetDedup::clear (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_window.store(0);
+	m_bDuplicates = false;
+}
+
+
+// Event content hash (FNV-1a, port included).
+unsigned int qmidinetDedup::hash (
+	const unsigned char *data, unsigned short len, int port )
+{
+	unsigned int h = 2166136261U;
+
+	h = (h ^ (port & 0xff)) * 16777619U;
+	for (unsigned short i = 0; i < len; ++i)
+		h = (h ^ data[i]) * 16777619U;
+
+	return h;
+}
+
+
+// Find a recent entry index by hash (or else one to replace).
+int qmidinetDedup::lookup (
+	unsigned int h, unsigned int t, bool *pbFound ) const
+{
+	const unsigned int window = m_window.load();
+
+	int iOldest = -1;
+	unsigned int oldest = 0;
+	for (int i = 0; i < ProbeSize; ++i) {
+		const int k = ((h + i) & (TableSize - 1));
+		const unsigned int age = t - m_table[k].time;
+		if (m_table[k].hash == h && age <= window) {
+			*pbFound = true;
+			return k;
+		}
+		if (iOldest < 0 || age > oldest) {
+			iOldest = k;
+			oldest = age;
+		}
+	}
+
+	*pbFound = false;
+	return iOldest;
+}
+
+
+// Record an event as received from the network.
+void qmidinetDedup::received (
+	const unsigned char *data, unsigned short len, int port )
+{
+	if (m_window.load() == 0 || len < 1)
+		return;
+
+	const unsigned int h = hash(data, len, port);
+
+	QMutexLocker locker(&m_mutex);
+
+	record(h);
+}
+
+
+// Same, but never waiting on the lock.
+bool qmidinetDedup::tryReceived (
+	const unsigned char *data, unsigned short len, int port )
+{
+	if (m_window.load() == 0 || len < 1)
+		return true;
+
+	const unsigned int h = hash(data, len, port);
+
+	if (!m_mutex.tryLock())
+		return false;
+
+	record(h);
+
+	m_mutex.unlock();
+	return true;
+}
+
+
+// Record a received event hash (locked).
+void qmidinetDedup::record ( unsigned int h )
+{
+	const unsigned int t = now();
+	bool bFound = false;
+	Entry& entry = m_table[lookup(h, t, &bFound)];
+	entry.hash = h;
+	entry.time = t;
+	entry.source = nullptr;
+}
+
+
+// Whether an event from a source (MIDI backend) is to be sent.
+bool qmidinetDedup::accept ( const unsigned char *data, unsigned short len,
+	int port, const void *pvSource )
+{
+	if (m_window.load() == 0 || len < 1)
+		return true;
+
+	const unsigned int h = hash(data, len, port);
+
+	QMutexLocker locker(&m_mutex);
+
+	const unsigned int t = now();
+	bool bFound = false;
+	Entry& entry = m_table[lookup(h, t, &bFound)];
+	if (bFound && entry.source != pvSource
+		&& (entry.source == nullptr || m_bDuplicates))
+		return false; // Echo or duplicate, drop it.
+
+	entry.hash = h;
+	entry.time = t;
+	entry.source = pvSource;
+
+	return true;
+}
+
+
+// end of qmidinetDedup.cpp
@@ -0,0 +1,115 @@
+// qmidinetDedup.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetDedup_h
+#define __qmidinetDedup_h
+
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include <atomic>
+
+
+//----------------------------------------------------------------------------
+// qmidinetDedup -- Duplicate and echo suppression (merge stage).
+//
+// Recently seen events are kept in a small hash table, keyed by their
+// content and MIDI port, along with their source (the MIDI backend that
+// sent them, or none for those received from the network) and time.
+// The same event from another source, within the time window, is then
+// taken as an echo (of something just received from the network) and
+// dropped; or else as a duplicate (eg. ALSA and JACK bridged to each
+// other), if those are also to be dropped (several MIDI backends).
+
+class qmidinetDedup
+{
+public:
+
+	// Constructor.
+	qmidinetDedup();
+
+	// Hash table (re)initializer (time window in msecs; none if zero),
+	// optionally dropping duplicates across MIDI backends, not just echoes.
+	void setup(int iWindow, bool bDuplicates = true);
+
+	// Hash table terminator.
+	void clear();
+
+	// Whether there's any suppression at all.
+	bool isActive() const { return (m_window.load() > 0); }
+
+	// Record an event as received from the network, for a MIDI port.
+	void received(const unsigned char *data, unsigned short len, int port);
+
+	// Same, but never waiting on the lock (eg. from a real-time thread);
+	// false if skipped, on contention.
+	bool tryReceived(const unsigned char *data, unsigned short len, int port);
+
+	// Whether an event from a source (MIDI backend) is to be sent;
+	// otherwise it's a duplicate or an echo, to be dropped.
+	bool accept(const unsigned char *data, unsigned short len,
+		int port, const void *pvSource);
+
+protected:
+
+	// Event content hash (FNV-1a, port included).
+	static unsigned int hash(const unsigned char *data,
+		unsigned short len, int port);
+
+	// Find a recent entry index by hash (or else one to replace).
+	int lookup(unsigned int h, unsigned int t, bool *pbFound) const;
+
+	// Record a received event hash (locked).
+	void record(unsigned int h);
+
+	// Current time (microseconds; wrapping).
+	unsigned int now() const
+		{ return (unsigned int) (m_timer.nsecsElapsed() / 1000); }
+
+private:
+
+	// Hash table size (a power of two) and probe length.
+	static const int TableSize = 1024;
+	static const int ProbeSize = 8;
+
+	// Hash table entry.
+	struct Entry
+	{
+		unsigned int hash;
+		unsigned int time;
+		const void  *source;
+	};
+
+	// Instance variables.
+	std::atomic<unsigned int> m_window;
+
+	bool          m_bDuplicates;
+
+	Entry         m_table[TableSize];
+
+	QElapsedTimer m_timer;
+	QMutex        m_mutex;
+};
+
+
+#endif	// __qmidinetDedup_h
+
+// end of qmidinetDedup.h
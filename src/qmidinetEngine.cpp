@@ -0,0 +1,345 @@
+// qmidinetEngine.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetEngine.h"
+#include "qmidinetOptions.h"
+
+
+//-------------------------------------------------------------------------
+// qmidinetEngine -- Network bridge core (headless).
+//
+
+// Constructor.
+qmidinetEngine::qmidinetEngine ( QObject *pParent )
+	: QObject(pParent), m_udpd(this)
+	#ifdef CONFIG_ALSA_MIDI
+		, m_alsa(this)
+		, m_alsaRaw(this)
+	#endif
+	#ifdef CONFIG_ALSA_UMP
+		, m_alsaUmp(this)
+	#endif
+	#ifdef CONFIG_JACK_MIDI
+		, m_jack(this)
+	#endif
+{
+	QObject::connect(
+		&m_udpd, SIGNAL(received(QByteArray, int)),
+		SIGNAL(receiving()));
+
+#ifdef CONFIG_ALSA_MIDI
+	attachDevice(&m_alsa);
+	attachDevice(&m_alsaRaw);
+#endif
+#ifdef CONFIG_ALSA_UMP
+	attachDevice(&m_alsaUmp);
+#endif
+#ifdef CONFIG_JACK_MIDI
+	attachDevice(&m_jack);
+	QObject::connect(&m_jack,
+		SIGNAL(shutdown()),
+		SLOT(jackShutdown()));
+	QObject::connect(&m_jack,
+		SIGNAL(reconnected()),
+		SIGNAL(reconnected()));
+#endif
+}
+
+
+// Destructor.
+qmidinetEngine::~qmidinetEngine (void)
+{
+	close();
+}
+
+
+// Backend network attachment.
+void qmidinetEngine::attachDevice ( qmidinetMidiDevice *pDevice )
+{
+	QObject::connect(
+		&m_udpd, SIGNAL(received(QByteArray, int)),
+		pDevice, SLOT(receive(QByteArray, int)));
+
+	QObject::connect(
+		pDevice, SIGNAL(sending()),
+		SIGNAL(sending()));
+}
+
+
+// Additional (run-time registered) backends setup/cleanup.
+bool qmidinetEngine::setupDevices ( const QStringList& backends, int iNumPorts )
+{
+	for (const QString& sBackend : backends) {
+		const QString& sName = sBackend.trimmed();
+		if (sName.isEmpty())
+			continue;
+		qmidinetMidiDevice *pDevice
+			= qmidinetMidiDevice::createDevice(sName, this);
+		if (pDevice == nullptr) {
+			emit error(tr("MIDI Backend Error"),
+				tr("Unknown MIDI backend: %1.\n\n"
+				"Available: %2.").arg(sName)
+				.arg(qmidinetMidiDevice::deviceNames().join(", ")));
+			return false;
+		}
+		attachDevice(pDevice);
+		m_devices.append(pDevice);
+		if (!pDevice->open(QMIDINET_TITLE, iNumPorts)) {
+			emit error(tr("MIDI Backend Error"),
+				tr("The %1 MIDI backend could not be established.")
+				.arg(sName));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void qmidinetEngine::clearDevices (void)
+{
+	qDeleteAll(m_devices);
+	m_devices.clear();
+}
+
+
+// (Re)initializer, from given settings.
+bool qmidinetEngine::setup ( qmidinetOptions *pOptions )
+{
+	close();
+
+	if (pOptions == nullptr)
+		return false;
+
+	// Network goes first, as MIDI devices
+	// may send straight into it; JACK alone
+	// may also read straight from it, as no
+	// other backend would get anything then...
+#ifdef CONFIG_JACK_MIDI
+	bool bJackPolled = (pOptions->bJackMidi && pOptions->bJackPolled);
+#ifdef CONFIG_ALSA_MIDI
+	if (pOptions->bAlsaMidi)
+		bJackPolled = false;
+#endif
+	for (const QString& sBackend : pOptions->backends) {
+		if (!sBackend.trimmed().isEmpty())
+			bJackPolled = false;
+	}
+	m_udpd.setPolled(bJackPolled);
+#endif
+	if (!qmidinetRoutes::isValid(pOptions->routes, pOptions->iNumPorts)) {
+		emit error(tr("Network Inferface Error"),
+			tr("The port routing is invalid: %1.")
+			.arg(pOptions->routes.join(", ")));
+		return false;
+	}
+	m_udpd.setRoutes(pOptions->routes);
+	if (!qmidinetFilter::isValid(pOptions->filters)) {
+		emit error(tr("Network Inferface Error"),
+			tr("The message filter is invalid: %1.")
+			.arg(pOptions->filters.join("; ")));
+		return false;
+	}
+	m_udpd.setFilters(pOptions->filters);
+	if (!qmidinetScheduler::isValid(pOptions->priorities)) {
+		emit error(tr("Network Inferface Error"),
+			tr("The source priorities are invalid: %1.")
+			.arg(pOptions->priorities.join(", ")));
+		return false;
+	}
+	m_udpd.setPriorities(pOptions->priorities);
+	m_udpd.setThinRate(pOptions->iThinRate);
+	m_udpd.setThinAlways(pOptions->bThinAlways);
+	// Echo suppression, always; duplicate suppression,
+	// only when more than one MIDI backend merges in...
+	int iBackends = 0;
+#ifdef CONFIG_ALSA_MIDI
+	if (pOptions->bAlsaMidi)
+		++iBackends;
+#endif
+#ifdef CONFIG_JACK_MIDI
+	if (pOptions->bJackMidi)
+		++iBackends;
+#endif
+	for (const QString& sBackend : pOptions->backends) {
+		if (!sBackend.trimmed().isEmpty())
+			++iBackends;
+	}
+	m_udpd.setDedupWindow(pOptions->iDedupWindow);
+	m_udpd.setDedupDuplicates(iBackends > 1);
+	if (!m_udpd.open(
+			pOptions->sInterface,
+			pOptions->sUdpAddr,
+			pOptions->iUdpPort,
+			pOptions->iNumPorts)) {
+		emit error(tr("Network Inferface Error"),
+			tr("The network interface could not be established.\n\n"
+			"Please, make sure you have an on-line network connection "
+			"and try again."));
+		return false;
+	}
+
+#ifdef CONFIG_ALSA_MIDI
+	m_alsa.setWireFormat(pOptions->iWireFormat);
+	m_alsa.setPlayoutDelay(pOptions->iAlsaPlayoutDelay);
+	m_alsa.setEventFilter(pOptions->iAlsaEventFilter);
+	bool bAlsaMidi = pOptions->bAlsaMidi;
+#ifdef CONFIG_ALSA_UMP
+	// MIDI 2.0 (UMP) sequencer client, instead of the legacy one...
+	m_alsaUmp.setWireFormat(pOptions->iWireFormat);
+	if (bAlsaMidi && pOptions->bAlsaUmp) {
+		if (!m_alsaUmp.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
+			m_alsaUmp.close();
+			m_udpd.close();
+			emit error(tr("ALSA MIDI Inferface Error"),
+				tr("The ALSA UMP (MIDI 2.0) interface could not be established.\n\n"
+				"Please, make sure you have a ALSA MIDI sub-system working "
+				"correctly and try again."));
+			return false;
+		}
+		bAlsaMidi = false;
+	}
+#endif
+	if (bAlsaMidi
+		&& !m_alsa.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
+		m_udpd.close();
+		emit error(tr("ALSA MIDI Inferface Error"),
+			tr("The ALSA MIDI interface could not be established.\n\n"
+			"Please, make sure you have a ALSA MIDI sub-system working "
+			"correctly and try again."));
+		return false;
+	}
+	m_alsaRaw.setDevices(pOptions->alsaRawMidiDevices);
+	if (pOptions->bAlsaMidi
+		&& !m_alsaRaw.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
+		m_alsaRaw.close();
+	#ifdef CONFIG_ALSA_UMP
+		m_alsaUmp.close();
+	#endif
+		m_alsa.close();
+		m_udpd.close();
+		emit error(tr("ALSA MIDI Inferface Error"),
+			tr("The ALSA raw MIDI devices could not be opened.\n\n"
+			"Please, make sure the configured hardware is present "
+			"and not busy, then try again."));
+		return false;
+	}
+#endif
+
+#ifdef CONFIG_JACK_MIDI
+	m_jack.setSpinTime(pOptions->iJackSpinTime);
+	m_jack.setWireFormat(pOptions->iWireFormat);
+	m_jack.setLatency(pOptions->iJackLatency);
+	m_jack.setRingBufferSize(pOptions->iJackRingBufferSize);
+	m_jack.setOverload(pOptions->iJackOverload);
+	m_jack.setNetworkPolled(bJackPolled);
+	if (pOptions->bJackMidi
+		&& !m_jack.open(QMIDINET_TITLE, pOptions->iNumPorts)) {
+	#ifdef CONFIG_ALSA_UMP
+		m_alsaUmp.close();
+	#endif
+	#ifdef CONFIG_ALSA_MIDI
+		m_alsaRaw.close();
+		m_alsa.close();
+	#endif
+		m_udpd.close();
+		emit error(tr("JACK MIDI Inferface Error"),
+			tr("The JACK MIDI interface could not be established.\n\n"
+			"Please, make sure you have a JACK MIDI sub-system working "
+			"correctly and try again."));
+		return false;
+	}
+#endif
+
+	// Additional backends, as registered...
+	if (!setupDevices(pOptions->backends, pOptions->iNumPorts)) {
+		clearDevices();
+	#ifdef CONFIG_JACK_MIDI
+		m_jack.close();
+	#endif
+	#ifdef CONFIG_ALSA_UMP
+		m_alsaUmp.close();
+	#endif
+	#ifdef CONFIG_ALSA_MIDI
+		m_alsaRaw.close();
+		m_alsa.close();
+	#endif
+		m_udpd.close();
+		return false;
+	}
+
+	return true;
+}
+
+
+// Terminator.
+void qmidinetEngine::close (void)
+{
+#ifdef CONFIG_JACK_MIDI
+	m_jack.close();
+#endif
+#ifdef CONFIG_ALSA_UMP
+	m_alsaUmp.close();
+#endif
+#ifdef CONFIG_ALSA_MIDI
+	m_alsaRaw.close();
+	m_alsa.close();
+#endif
+	clearDevices();
+	m_udpd.close();
+}
+
+
+// Runtime statistics (human readable).
+QString qmidinetEngine::statistics (void) const
+{
+	QString sText = m_udpd.statistics();
+
+#ifdef CONFIG_JACK_MIDI
+	sText += m_jack.statistics();
+#endif
+
+	for (const qmidinetMidiDevice *pDevice : m_devices)
+		sText += pDevice->statistics();
+
+	if (sText.isEmpty())
+		sText = tr("No statistics available.");
+
+	return sText;
+}
+
+
+#ifdef CONFIG_JACK_MIDI
+
+// JACK server shutdown slot.
+void qmidinetEngine::jackShutdown (void)
+{
+	// Keep the network up, while
+	// waiting for the server to return...
+	m_jack.reconnect();
+
+	emit shutdown();
+}
+
+#endif
+
+
+// end of qmidinetEngine.cpp
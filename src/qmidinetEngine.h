@@ -0,0 +1,122 @@
+// qmidinetEngine.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetEngine_h
+#define __qmidinetEngine_h
+
+#include "qmidinetUdpDevice.h"
+#include "qmidinetMidiDevice.h"
+
+#include "qmidinetAlsaMidiDevice.h"
+#include "qmidinetAlsaRawMidiDevice.h"
+#include "qmidinetAlsaUmpDevice.h"
+#include "qmidinetJackMidiDevice.h"
+
+#include <QList>
+
+
+// Forward decls.
+class qmidinetOptions;
+
+
+//-------------------------------------------------------------------------
+// qmidinetEngine -- Network bridge core (headless).
+//
+// Owns the network device and all MIDI backends, wiring each other;
+// needs no more than QtCore (and QtNetwork, when built with IPv6
+// support), so it may be run (or embedded) without any GUI whatsoever.
+
+class qmidinetEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetEngine(QObject *pParent = nullptr);
+
+	// Destructor.
+	~qmidinetEngine();
+
+	// (Re)initializer, from given settings.
+	bool setup(qmidinetOptions *pOptions);
+
+	// Terminator.
+	void close();
+
+	// Runtime statistics (human readable).
+	QString statistics() const;
+
+signals:
+
+	// Sent/received data (to/from network) signals.
+	void sending();
+	void receiving();
+
+	// Error notification.
+	void error(const QString& sTitle, const QString& sText);
+
+#ifdef CONFIG_JACK_MIDI
+	// JACK server notifications.
+	void shutdown();
+	void reconnected();
+#endif
+
+protected slots:
+
+#ifdef CONFIG_JACK_MIDI
+	// JACK server shutdown slot.
+	void jackShutdown();
+#endif
+
+protected:
+
+	// Backend network attachment.
+	void attachDevice(qmidinetMidiDevice *pDevice);
+
+	// Additional (run-time registered) backends setup/cleanup.
+	bool setupDevices(const QStringList& backends, int iNumPorts);
+	void clearDevices();
+
+private:
+
+	// Network device goes first (and last destroyed).
+	qmidinetUdpDevice m_udpd;
+
+#ifdef CONFIG_ALSA_MIDI
+	qmidinetAlsaMidiDevice m_alsa;
+	qmidinetAlsaRawMidiDevice m_alsaRaw;
+#endif
+#ifdef CONFIG_ALSA_UMP
+	qmidinetAlsaUmpDevice m_alsaUmp;
+#endif
+
+	// Additional (run-time registered) backends.
+	QList<qmidinetMidiDevice *> m_devices;
+#ifdef CONFIG_JACK_MIDI
+	qmidinetJackMidiDevice m_jack;
+#endif
+};
+
+
+#endif	// __qmidinetEngine_h
+
+// end of qmidinetEngine.h
@@ -0,0 +1,399 @@
+// qmidinetFilter.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetFilter.h"
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// Message type names (by status byte, or status nibble for channel ones).
+
+static const struct
+{
+	const char   *name;
+	unsigned char status;
+
+} g_filter_types[] = {
+
+	{ "note",             0x80 },
+	{ "note",             0x90 },
+	{ "note-off",         0x80 },
+	{ "note-on",          0x90 },
+	{ "key-pressure",     0xa0 },
+	{ "controller",       0xb0 },
+	{ "program",          0xc0 },
+	{ "channel-pressure", 0xd0 },
+	{ "pitch-bend",       0xe0 },
+	{ "sysex",            0xf0 },
+	{ "mtc",              0xf1 },
+	{ "song-position",    0xf2 },
+	{ "song-select",      0xf3 },
+	{ "tune-request",     0xf6 },
+	{ "clock",            0xf8 },
+	{ "tick",             0xf9 },
+	{ "transport",        0xfa },
+	{ "transport",        0xfb },
+	{ "transport",        0xfc },
+	{ "start",            0xfa },
+	{ "continue",         0xfb },
+	{ "stop",             0xfc },
+	{ "sensing",          0xfe },
+	{ "reset",            0xff },
+
+	{ nullptr, 0 }
+};
+
+
+// Range list parser (eg. "1-4,10") into a bitmask array.
+static bool qmidinetFilter_ranges (
+	const QString& sRanges, int iMin, int iMax, unsigned int *mask )
+{
+	const QStringList& ranges = sRanges.split(',');
+	for (const QString& sRange : ranges) {
+		const int iDash = sRange.indexOf('-');
+		bool bFirst = false;
+		bool bLast = false;
+		int iFirst = 0;
+		int iLast = 0;
+		if (iDash < 0) {
+			iFirst = iLast = sRange.toInt(&bFirst);
+			bLast = bFirst;
+		} else {
+			iFirst = sRange.left(iDash).toInt(&bFirst);
+			iLast = sRange.mid(iDash + 1).toInt(&bLast);
+		}
+		if (!bFirst || !bLast || iFirst < iMin || iLast > iMax || iFirst > iLast)
+			return false;
+		for (int i = iFirst - iMin; i <= iLast - iMin; ++i)
+			mask[i >> 5] |= (1U << (i & 0x1f));
+	}
+
+	return true;
+}
+
+
+// Bitmask array probe.
+static inline bool qmidinetFilter_test ( const unsigned int *mask, int i )
+{
+	return (mask[i >> 5] & (1U << (i & 0x1f)));
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetFilter -- MIDI message filter (per port and direction).
+
+// Constructor.
+qmidinetFilter::qmidinetFilter (void)
+{
+	reset();
+}
+
+
+// No filtering at all.
+void qmidinetFilter::reset (void)
+{
+	::memset(m_tables, 0, sizeof(m_tables));
+
+	m_active[0] = m_active[1] = 0;
+}
+
+
+// Compile textual rules.
+bool qmidinetFilter::compile ( const QStringList& rules )
+{
+	reset();
+
+	for (const QString& sRule : rules) {
+		if (!compileRule(sRule)) {
+			reset();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Compile a single textual rule.
+bool qmidinetFilter::compileRule ( const QString& sRule )
+{
+	unsigned int ports[1] = { 0 };
+	unsigned int dirs = qmidinetRoutes::Duplex;
+	unsigned int types[8] = { 0 };
+	unsigned int channels[1] = { 0 };
+	unsigned int controllers[4] = { 0 };
+	bool bTypes = false;
+	bool bChannels = false;
+	bool bControllers = false;
+
+	const QStringList& items = sRule.simplified().split(' ');
+	for (const QString& sItem : items) {
+		if (sItem.isEmpty())
+			continue;
+		const int iEqual = sItem.indexOf('=');
+		if (iEqual < 1)
+			return false;
+		const QString& sKey = sItem.left(iEqual);
+		const QString& sVal = sItem.mid(iEqual + 1);
+		if (sKey == "port") {
+			if (!qmidinetFilter_ranges(sVal,
+					0, qmidinetRoutes::MaxPorts - 1, ports))
+				return false;
+		}
+		else
+		if (sKey == "dir") {
+			if (sVal == "in")
+				dirs = qmidinetRoutes::Receive;
+			else
+			if (sVal == "out")
+				dirs = qmidinetRoutes::Send;
+			else
+			if (sVal == "both")
+				dirs = qmidinetRoutes::Duplex;
+			else
+				return false;
+		}
+		else
+		if (sKey == "types") {
+			const QStringList& names = sVal.split(',');
+			for (const QString& sName : names) {
+				bool bName = false;
+				for (int i = 0; g_filter_types[i].name; ++i) {
+					if (sName != g_filter_types[i].name)
+						continue;
+					const unsigned char status = g_filter_types[i].status;
+					const int n = (status < 0xf0 ? 16 : 1);
+					for (int j = 0; j < n; ++j)
+						types[(status + j) >> 5] |= (1U << ((status + j) & 0x1f));
+					bName = true;
+				}
+				if (!bName)
+					return false;
+			}
+			bTypes = true;
+		}
+		else
+		if (sKey == "channels") {
+			if (!qmidinetFilter_ranges(sVal, 1, 16, channels))
+				return false;
+			bChannels = true;
+		}
+		else
+		if (sKey == "controllers") {
+			if (!qmidinetFilter_ranges(sVal, 0, 127, controllers))
+				return false;
+			bControllers = true;
+		}
+		else return false;
+	}
+
+	// Nothing to match?
+	if (!bTypes && !bChannels && !bControllers)
+		return false;
+
+	// Default to all ports...
+	if (ports[0] == 0)
+		ports[0] = ~0U;
+
+	// Default to all types (controllers only, if given)...
+	if (!bTypes) {
+		for (int status = 0x80; status < 0x100; ++status) {
+			if (!bControllers || (status & 0xf0) == 0xb0)
+				types[status >> 5] |= (1U << (status & 0x1f));
+		}
+	}
+
+	for (int d = 0; d < 2; ++d) {
+		if ((dirs & (d == 0 ? qmidinetRoutes::Receive : qmidinetRoutes::Send)) == 0)
+			continue;
+		for (int port = 0; port < qmidinetRoutes::MaxPorts; ++port) {
+			if ((ports[0] & (1U << port)) == 0)
+				continue;
+			Table& table = m_tables[d][port];
+			for (int status = 0x80; status < 0x100; ++status) {
+				if (!qmidinetFilter_test(types, status))
+					continue;
+				// Conditions that can't apply don't match...
+				const int channel = (status & 0x0f);
+				if (bChannels && (status >= 0xf0
+					|| !qmidinetFilter_test(channels, channel)))
+					continue;
+				if (bControllers && (status & 0xf0) != 0xb0)
+					continue;
+				if (bControllers) {
+					for (int i = 0; i < 4; ++i)
+						table.controllers[channel][i] |= controllers[i];
+				}
+				else table.status[status >> 5] |= (1U << (status & 0x1f));
+			}
+			m_active[d] |= (1U << port);
+		}
+	}
+
+	return true;
+}
+
+
+// Whether a single MIDI message is to be let through.
+bool qmidinetFilter::accept ( const unsigned char *data, unsigned short len,
+	int port, qmidinetRoutes::Direction direction ) const
+{
+	if (!isActive(port, direction) || len < 1)
+		return true;
+
+	const Table& table = m_tables[index(direction)][port];
+
+	// SysEx continuation and end bytes count as SysEx...
+	unsigned char status = data[0];
+	if (status < 0x80 || status == 0xf7)
+		status = 0xf0;
+
+	if (qmidinetFilter_test(table.status, status))
+		return false;
+
+	if ((status & 0xf0) == 0xb0 && len > 1
+		&& qmidinetFilter_test(table.controllers[status & 0x0f], data[1] & 0x7f))
+		return false;
+
+	return true;
+}
+
+
+// Whether a single MIDI message is to be kept, through all stages
+// (duplicates go before thinning, not to take any of its slots).
+bool qmidinetFilter::keep ( const unsigned char *data, unsigned short len,
+	int port, qmidinetRoutes::Direction direction, bool bActive,
+	qmidinetThinner *pThinner, qmidinetDedup *pDedup, const void *pvSource ) const
+{
+	if (bActive && !accept(data, len, port, direction))
+		return false;
+
+	if (pDedup && !pDedup->accept(data, len, port, pvSource))
+		return false;
+
+	if (pThinner && !pThinner->accept(data, len, port))
+		return false;
+
+	return true;
+}
+
+
+// Filter a whole datagram (of any format).
+const unsigned char *qmidinetFilter::filter (
+	const unsigned char *data, unsigned short *len,
+	int port, qmidinetRoutes::Direction direction, unsigned char *buf,
+	qmidinetThinner *pThinner, qmidinetDedup *pDedup, const void *pvSource ) const
+{
+	const bool bActive = isActive(port, direction);
+	if (pThinner && !pThinner->isActive())
+		pThinner = nullptr;
+	if (pDedup && !pDedup->isActive())
+		pDedup = nullptr;
+	if (!bActive && pThinner == nullptr && pDedup == nullptr)
+		return data;
+
+	// First pass: decide on each event, once...
+	bool keeps[MaxSize];
+	int ncount = 0;
+	int ndrops = 0;
+
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short nlen = 0;
+
+	qmidinetUdpPacketReader packet(data, *len);
+	const qmidinetUdpPacket::Format format = packet.format();
+	if (format == qmidinetUdpPacket::Ump) {
+		unsigned int ump[qmidinetUmp::MaxWords];
+		unsigned char decoded[qmidinetUmp::MaxDecodeSize];
+		unsigned short nwords = 0;
+		while (ncount < MaxSize && packet.readUmp(ump, &nwords)) {
+			const unsigned short n = qmidinetUmp::decode(ump, decoded);
+			keeps[ncount] = (n < 1 || keep(decoded, n, port, direction,
+				bActive, pThinner, pDedup, pvSource));
+			if (!keeps[ncount++])
+				++ndrops;
+		}
+	} else {
+		while (ncount < MaxSize && packet.read(&delta, &pchData, &nlen)) {
+			keeps[ncount] = keep(pchData, nlen, port, direction,
+				bActive, pThinner, pDedup, pvSource);
+			if (!keeps[ncount++])
+				++ndrops;
+		}
+	}
+
+	if (ndrops < 1)
+		return data;
+	if (ndrops >= ncount)
+		return nullptr;
+
+	// Second pass: rewrite what's kept...
+	int k = 0;
+	qmidinetUdpPacketReader packet2(data, *len);
+	if (format == qmidinetUdpPacket::Raw) {
+		unsigned short n = 0;
+		while (packet2.read(&delta, &pchData, &nlen)) {
+			if ((k < ncount && !keeps[k++]) || n + nlen > MaxSize)
+				continue;
+			::memcpy(buf + n, pchData, nlen);
+			n += nlen;
+		}
+		*len = n;
+		return buf;
+	}
+
+	qmidinetUdpPacketWriter writer;
+	if (format == qmidinetUdpPacket::Ump) {
+		writer.setFormat(qmidinetUdpPacket::Ump, packet2.port());
+		unsigned int ump[qmidinetUmp::MaxWords];
+		unsigned short nwords = 0;
+		while (packet2.readUmp(ump, &nwords)) {
+			if (k >= ncount || keeps[k++])
+				writer.writeUmp(ump, nwords);
+		}
+	} else {
+		// Same header (sequence number and timestamp) as the original...
+		unsigned long time = packet2.timestamp();
+		writer.begin(packet2.seqno(), time);
+		while (packet2.read(&delta, &pchData, &nlen)) {
+			time += delta;
+			if (k >= ncount || keeps[k++])
+				writer.write(time, pchData, nlen);
+		}
+	}
+
+	*len = writer.length();
+	::memcpy(buf, writer.data(), *len);
+	return buf;
+}
+
+
+// Textual rules validator.
+bool qmidinetFilter::isValid ( const QStringList& rules )
+{
+	qmidinetFilter filter;
+	return filter.compile(rules);
+}
+
+
+// end of qmidinetFilter.cpp
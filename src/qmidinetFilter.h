@@ -0,0 +1,122 @@
+// qmidinetFilter.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetFilter_h
+#define __qmidinetFilter_h
+
+#include "qmidinetRoutes.h"
+#include "qmidinetThinner.h"
+#include "qmidinetDedup.h"
+#include "qmidinetUdpPacket.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetFilter -- MIDI message filter (per port and direction).
+//
+// Rules are given as text, one per entry, as whitespace separated
+// key=value pairs, all optional but one, matching what gets dropped:
+//
+//   port=<ranges>          ports (from zero; default all);
+//   dir=in|out|both        from/to the network (default both);
+//   types=<names>          message types (eg. sensing,clock,sysex);
+//   channels=<ranges>      channels (1-16);
+//   controllers=<ranges>   controller numbers (0-127).
+//
+// Conditions in one rule must all match, so one that can't apply to a
+// message type doesn't match it (eg. channels for clock, controllers for
+// notes); rules add up. They get compiled into bitmask tables, looked up
+// by status byte (and controller number).
+
+class qmidinetFilter
+{
+public:
+
+	// Largest filtered (rewritten) datagram size
+	// (as received and reassembled, see qmidinetSenders).
+	static const unsigned short MaxSize = 3 * qmidinetUdpPacket::MaxSize;
+
+	// Constructor.
+	qmidinetFilter();
+
+	// No filtering at all.
+	void reset();
+
+	// Compile textual rules (false if any is malformed;
+	// the filter is then left with no rules at all).
+	bool compile(const QStringList& rules);
+
+	// Whether any rule applies to a port and direction.
+	bool isActive(int port, qmidinetRoutes::Direction direction) const
+	{
+		return (port >= 0 && port < qmidinetRoutes::MaxPorts
+			&& (m_active[index(direction)] & (1U << port)));
+	}
+
+	// Whether a single MIDI message is to be let through.
+	bool accept(const unsigned char *data, unsigned short len,
+		int port, qmidinetRoutes::Direction direction) const;
+
+	// Filter a whole datagram (of any format), optionally thinned and
+	// deduplicated too (as from the given source): returns the same data
+	// if nothing is dropped, nullptr if everything is, or else the given
+	// buffer (at least MaxSize long), rewritten with what's left.
+	const unsigned char *filter(const unsigned char *data, unsigned short *len,
+		int port, qmidinetRoutes::Direction direction, unsigned char *buf,
+		qmidinetThinner *pThinner = nullptr,
+		qmidinetDedup *pDedup = nullptr, const void *pvSource = nullptr) const;
+
+	// Textual rule parser (false if malformed).
+	static bool isValid(const QStringList& rules);
+
+protected:
+
+	// Table index from direction.
+	static int index(qmidinetRoutes::Direction direction)
+		{ return (direction == qmidinetRoutes::Send ? 1 : 0); }
+
+	// Compile a single textual rule (false if malformed).
+	bool compileRule(const QString& sRule);
+
+	// Whether a single MIDI message is to be kept, through all stages.
+	bool keep(const unsigned char *data, unsigned short len,
+		int port, qmidinetRoutes::Direction direction, bool bActive,
+		qmidinetThinner *pThinner,
+		qmidinetDedup *pDedup, const void *pvSource) const;
+
+private:
+
+	// Compiled table, per port and direction.
+	struct Table
+	{
+		unsigned int status[8];           // by status byte.
+		unsigned int controllers[16][4];  // by channel and number.
+	};
+
+	Table m_tables[2][qmidinetRoutes::MaxPorts];
+
+	// Ports with any rule, per direction (bitmask).
+	unsigned int m_active[2];
+};
+
+
+#endif	// __qmidinetFilter_h
+
+// end of qmidinetFilter.h
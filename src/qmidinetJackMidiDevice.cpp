@@ -23,9 +23,27 @@
 
 #ifdef CONFIG_JACK_MIDI
 
+#include "qmidinetUdpDevice.h"
+#include "qmidinetUdpPacket.h"
+#include "qmidinetThinner.h"
+
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QElapsedTimer>
+
+#if defined(Q_OS_LINUX)
+#include <time.h>
+#include <errno.h>
+#endif
+
+#if defined(Q_OS_UNIX)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include <string.h>
 
 
 // JACK MIDI event, plus the port its destined for...
@@ -269,6 +287,109 @@ static void qmidinetJackMidiDevice_shutdown ( void *pvArg )
 }
 
 
+//----------------------------------------------------------------------
+// qmidinetJackMidiDevice_port_connect -- JACK port (dis)connect callback.
+//
+
+static void qmidinetJackMidiDevice_port_connect (
+	jack_port_id_t, jack_port_id_t, int, void *pvArg )
+{
+	qmidinetJackMidiDevice *pJackMidiDevice
+		= static_cast<qmidinetJackMidiDevice *> (pvArg);
+
+	pJackMidiDevice->connectNotify();
+}
+
+
+//----------------------------------------------------------------------
+// qmidinetJackMidiDevice_latency -- JACK client latency callback.
+//
+
+static void qmidinetJackMidiDevice_latency (
+	jack_latency_callback_mode_t mode, void *pvArg )
+{
+	qmidinetJackMidiDevice *pJackMidiDevice
+		= static_cast<qmidinetJackMidiDevice *> (pvArg);
+
+	pJackMidiDevice->latencyNotify(mode);
+}
+
+
+//----------------------------------------------------------------------
+// qmidinetJackMidiDevice_xrun -- JACK client XRUN callback.
+//
+
+static int qmidinetJackMidiDevice_xrun ( void *pvArg )
+{
+	qmidinetJackMidiDevice *pJackMidiDevice
+		= static_cast<qmidinetJackMidiDevice *> (pvArg);
+
+	pJackMidiDevice->xrunNotify();
+
+	return 0;
+}
+
+
+//----------------------------------------------------------------------
+// qmidinetJackMidiDevice_buffer_size -- JACK client buffer-size callback.
+//
+
+static int qmidinetJackMidiDevice_buffer_size ( jack_nframes_t nframes, void *pvArg )
+{
+	qmidinetJackMidiDevice *pJackMidiDevice
+		= static_cast<qmidinetJackMidiDevice *> (pvArg);
+
+	pJackMidiDevice->bufferSizeNotify(nframes);
+
+	return 0;
+}
+
+
+//----------------------------------------------------------------------
+// qmidinetJackMidiDevice_superseded -- Overload thinning helpers.
+//
+// Whether a continuous controller value is superseded by a newer one,
+// for the same channel and controller (or key), later in the same
+// cycle (or datagram); only those are safe to be dropped.
+
+static bool qmidinetJackMidiDevice_superseded ( void *pvBufferIn,
+	int n, int nevents, const jack_midi_event_t& event )
+{
+	const int key = qmidinetThinner::index(event.buffer, event.size);
+	if (key < 0)
+		return false;
+
+	for (int m = n + 1; m < nevents; ++m) {
+		jack_midi_event_t next;
+		jack_midi_event_get(&next, pvBufferIn, m);
+		if (qmidinetThinner::index(next.buffer, next.size) == key)
+			return true;
+	}
+
+	return false;
+}
+
+static bool qmidinetJackMidiDevice_superseded (
+	const qmidinetUdpPacketReader& packet,
+	const unsigned char *data, unsigned short len )
+{
+	const int key = qmidinetThinner::index(data, len);
+	if (key < 0)
+		return false;
+
+	qmidinetUdpPacketReader next(packet);
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short nlen = 0;
+	while (next.read(&delta, &pchData, &nlen)) {
+		if (qmidinetThinner::index(pchData, nlen) == key)
+			return true;
+	}
+
+	return false;
+}
+
+
 //----------------------------------------------------------------------------
 // qmidinetJackMidiThread -- JACK MIDI transfer thread.
 //
@@ -287,8 +408,12 @@ public:
 	// Wake from executive wait condition (RT-safe).
 	void sync();
 
-	// Sleep for some microseconds.
-	void usleep(unsigned long usecs);
+	// Monotonic clock reading (nanoseconds).
+	qint64 clock_nsecs() const;
+
+	// Sleep until an absolute deadline (monotonic nanoseconds),
+	// optionally spinning through its last few microseconds.
+	void sleep_until(qint64 deadline, unsigned long spin_usecs = 0);
 
 protected:
 
@@ -303,6 +428,9 @@ private:
 	// Thread synchronization objects.
 	QMutex m_mutex;
 	QWaitCondition m_cond;
+
+	// Fallback monotonic clock.
+	QElapsedTimer m_clock;
 };
 
 
@@ -310,6 +438,7 @@ private:
 qmidinetJackMidiThread::qmidinetJackMidiThread (void)
 	: QThread(), m_bRunState(false)
 {
+	m_clock.start();
 }
 
 
@@ -355,10 +484,47 @@ void qmidinetJackMidiThread::sync (void)
 }
 
 
-// Sleep for some microseconds.
-void qmidinetJackMidiThread::usleep ( unsigned long usecs )
+// Monotonic clock reading (nanoseconds).
+qint64 qmidinetJackMidiThread::clock_nsecs (void) const
 {
-	QThread::usleep(usecs);
+#if defined(Q_OS_LINUX)
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return qint64(ts.tv_sec) * 1000000000LL + qint64(ts.tv_nsec);
+#else
+	return m_clock.nsecsElapsed();
+#endif
+}
+
+
+// Sleep until an absolute deadline (monotonic nanoseconds),
+// optionally spinning through its last few microseconds.
+void qmidinetJackMidiThread::sleep_until (
+	qint64 deadline, unsigned long spin_usecs )
+{
+	const qint64 spin_nsecs = qint64(spin_usecs) * 1000LL;
+	const qint64 wake_nsecs = deadline - spin_nsecs;
+
+	if (wake_nsecs > clock_nsecs()) {
+	#if defined(Q_OS_LINUX)
+		struct timespec ts;
+		ts.tv_sec  = time_t(wake_nsecs / 1000000000LL);
+		ts.tv_nsec = long(wake_nsecs % 1000000000LL);
+		while (::clock_nanosleep(CLOCK_MONOTONIC,
+			TIMER_ABSTIME, &ts, nullptr) == EINTR)
+			;
+	#else
+		const qint64 nsecs = wake_nsecs - clock_nsecs();
+		if (nsecs > 0)
+			QThread::usleep((unsigned long) (nsecs / 1000LL));
+	#endif
+	}
+
+	// Busy-wait for the remaining of it...
+	if (spin_nsecs > 0) {
+		while (clock_nsecs() < deadline)
+			;
+	}
 }
 
 
@@ -370,11 +536,33 @@ qmidinetJackMidiDevice *qmidinetJackMidiDevice::g_pDevice = nullptr;
 
 // Constructor.
 qmidinetJackMidiDevice::qmidinetJackMidiDevice ( QObject *pParent )
-	: QObject(pParent), m_nports(0), m_pJackClient(nullptr),
+	: qmidinetMidiDevice(pParent), m_nports(0), m_iNumPorts(0),
+		m_connects_dirty(false), m_pJackClient(nullptr),
 		m_ppJackPortIn(nullptr), m_ppJackPortOut(nullptr),
 		m_pJackBufferIn(nullptr), m_pJackBufferOut(nullptr),
+		m_pchBufferIn(nullptr), m_pchBufferOut(nullptr),
+		m_last_frame_time(0), m_spin_time(0),
+		m_iWireFormat(qmidinetUdpPacket::Raw), m_pPackets(nullptr), m_nsent(0),
+		m_latency(0), m_latency_in(0), m_latency_out(0),
+		m_delay_in_max(0),
+		m_ringbuffer_size(0), m_ringbuffer_bytes(0), m_ringbuffer_peak(0),
+		m_iOverload(DropNewest), m_pDrops(nullptr), m_bPolled(false),
 		m_pQueueIn(nullptr), m_pRecvThread(nullptr)
 {
+	::memset(&m_profile, 0, sizeof(m_profile));
+
+	m_latency_timer.setInterval(1000);
+
+	QObject::connect(&m_latency_timer,
+		SIGNAL(timeout()),
+		SLOT(latencyUpdate()));
+
+	m_reconnect_timer.setInterval(250);
+
+	QObject::connect(&m_reconnect_timer,
+		SIGNAL(timeout()),
+		SLOT(reconnectTimeout()));
+
 	g_pDevice = this;
 }
 
@@ -401,14 +589,29 @@ bool qmidinetJackMidiDevice::open ( const QString& sClientName, int iNumPorts )
 	// Close if already open.
 	close();
 
+	// Remember for later (re)connection...
+	m_sClientName = sClientName;
+	m_iNumPorts = iNumPorts;
+
+	// Forget previous connections...
+	m_connects.clear();
+	m_restores.clear();
+
+	return openClient(JackNullOption);
+}
+
+
+// Device client (re)initialization method.
+bool qmidinetJackMidiDevice::openClient ( jack_options_t options )
+{
 	// Open new JACK client...
-	const QByteArray aClientName = sClientName.toLocal8Bit();
+	const QByteArray aClientName = m_sClientName.toLocal8Bit();
 	m_pJackClient = jack_client_open(
-		aClientName.constData(), JackNullOption, nullptr);
+		aClientName.constData(), options, nullptr);
 	if (m_pJackClient == nullptr)
 		return false;
 
-	m_nports = iNumPorts;
+	m_nports = m_iNumPorts;
 
 	int i;
 
@@ -434,21 +637,94 @@ bool qmidinetJackMidiDevice::open ( const QString& sClientName, int iNumPorts )
 			JackPortIsOutput, 0);
 	}
 
-	// Create transient buffers.
-	m_pJackBufferIn  = jack_ringbuffer_create(1024 * m_nports);
-	m_pJackBufferOut = jack_ringbuffer_create(1024 * m_nports);
+	// Create transient buffers; when not explicitly configured,
+	// auto-size to a few bytes per frame per port, but no less
+	// than twice the peak burst ever observed (up to a limit)...
+	unsigned int nbytes = m_ringbuffer_size;
+	if (nbytes < 1) {
+		nbytes = 4 * jack_get_buffer_size(m_pJackClient);
+		if (nbytes < 1024)
+			nbytes = 1024;
+		nbytes *= m_nports;
+		if (nbytes < 2 * m_ringbuffer_peak) {
+			const unsigned int nmax = 16 * nbytes;
+			nbytes = 2 * m_ringbuffer_peak;
+			if (nbytes > nmax)
+				nbytes = nmax;
+		}
+	}
+	else nbytes *= m_nports;
+
+	m_pJackBufferIn  = jack_ringbuffer_create(nbytes);
+	m_pJackBufferOut = jack_ringbuffer_create(nbytes);
+
+	// Actual capacity (rounded up to a power of two)...
+	m_ringbuffer_bytes = m_pJackBufferIn->size - 1;
+
+	// Scratch buffers, so that events are put together off the stack...
+	m_pchBufferIn  = new unsigned char [m_ringbuffer_bytes];
+	m_pchBufferOut = new unsigned char [m_ringbuffer_bytes];
+
+	// Prepare the queue sorter stuff; sized in events, as many as
+	// the smallest ones that would ever fit in the ring-buffer...
+	const unsigned int nslack = sizeof(qmidinetJackMidiEvent) + 1;
+	m_pQueueIn = new qmidinetJackMidiQueue(nbytes / nslack, nslack);
 
-	// Prepare the queue sorter stuff...
-	m_pQueueIn = new qmidinetJackMidiQueue(1024 * m_nports, 8);
+	// Prepare the dropped event counters...
+	m_pDrops = new Drops [m_nports];
+	for (i = 0; i < m_nports; ++i) {
+		m_pDrops[i].events_in.store(0);
+		m_pDrops[i].bytes_in.store(0);
+		m_pDrops[i].events_out.store(0);
+		m_pDrops[i].bytes_out.store(0);
+	}
+
+	// Prepare the time-stamped datagrams...
+	m_pPackets = new qmidinetUdpPacketWriter [m_nports];
+	setWireFormat(m_iWireFormat);
 	
 	// Set and go usual callbacks...
 	jack_set_process_callback(m_pJackClient,
 		qmidinetJackMidiDevice_process, this);
 	jack_on_shutdown(m_pJackClient,
 		qmidinetJackMidiDevice_shutdown, this);
+	jack_set_port_connect_callback(m_pJackClient,
+		qmidinetJackMidiDevice_port_connect, this);
+
+	// Port latencies start at one period...
+	m_latency_in  = jack_get_buffer_size(m_pJackClient);
+	m_latency_out = m_latency_in;
+	m_delay_in_max.store(0);
+
+	jack_set_latency_callback(m_pJackClient,
+		qmidinetJackMidiDevice_latency, this);
+
+	// Reset the process-cycle profiler...
+	::memset(&m_profile, 0, sizeof(m_profile));
+	bufferSizeNotify(jack_get_buffer_size(m_pJackClient));
+
+	jack_set_xrun_callback(m_pJackClient,
+		qmidinetJackMidiDevice_xrun, this);
+	jack_set_buffer_size_callback(m_pJackClient,
+		qmidinetJackMidiDevice_buffer_size, this);
+
+#if defined(Q_OS_UNIX)
+	// Discard any stale datagrams (eg. while reconnecting)...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	for (i = 0; m_bPolled && pUdpDevice && i < m_nports; ++i) {
+		const int sockin = pUdpDevice->socketIn(i);
+		unsigned char buf[qmidinetUdpPacket::MaxSize];
+		while (sockin >= 0
+			&& ::recv(sockin, (char *) buf, sizeof(buf), MSG_DONTWAIT) > 0)
+			;
+	}
+#endif
 
 	jack_activate(m_pJackClient);
 
+	// Keep an eye on measured latencies...
+	m_latency_timer.start();
+
 	// Start listener thread...
 	m_pRecvThread = new qmidinetJackMidiThread();
 	m_pRecvThread->start();
@@ -461,6 +737,9 @@ bool qmidinetJackMidiDevice::open ( const QString& sClientName, int iNumPorts )
 // Device termination method.
 void qmidinetJackMidiDevice::close (void)
 {
+	m_reconnect_timer.stop();
+	m_latency_timer.stop();
+
 	if (m_pRecvThread) {
 		if (m_pRecvThread->isRunning()) do {
 			m_pRecvThread->setRunState(false);
@@ -504,11 +783,33 @@ void qmidinetJackMidiDevice::close (void)
 		m_pJackBufferOut = nullptr;
 	}
 
+	if (m_pchBufferIn) {
+		delete [] m_pchBufferIn;
+		m_pchBufferIn = nullptr;
+	}
+
+	if (m_pchBufferOut) {
+		delete [] m_pchBufferOut;
+		m_pchBufferOut = nullptr;
+	}
+
 	if (m_pQueueIn) {
 		delete m_pQueueIn;
 		m_pQueueIn = nullptr;
 	}
 
+	if (m_pPackets) {
+		delete [] m_pPackets;
+		m_pPackets = nullptr;
+	}
+
+	if (m_pDrops) {
+		delete [] m_pDrops;
+		m_pDrops = nullptr;
+	}
+
+	m_ringbuffer_bytes = 0;
+
 	m_nports = 0;
 }
 
@@ -522,37 +823,43 @@ void qmidinetJackMidiDevice::capture (void)
 	char *pchBuffer;
 	qmidinetJackMidiEvent ev;
 
+	if (m_iOverload == DropOldest)
+		dropOldest(m_pJackBufferIn, false);
+
+	// Falling behind? the network is to be thinned out...
+	if (jack_ringbuffer_read_space(m_pJackBufferIn) > (m_ringbuffer_bytes >> 1)) {
+		qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+		if (pUdpDevice)
+			pUdpDevice->congest();
+	}
+
 	while (jack_ringbuffer_peek(m_pJackBufferIn,
 			(char *) &ev, sizeof(ev)) == sizeof(ev)) {
 		jack_ringbuffer_read_advance(m_pJackBufferIn, sizeof(ev));
 		pchBuffer = m_pQueueIn->push(ev.port, ev.event.time, ev.event.size);
-		if (pchBuffer)
+		if (pchBuffer) {
 			jack_ringbuffer_read(m_pJackBufferIn, pchBuffer, ev.event.size);
-		else
+		} else {
 			jack_ringbuffer_read_advance(m_pJackBufferIn, ev.event.size);
+			dropEvent(ev.port, ev.event.size, false);
+		}
 	}
 
-	float sample_rate = jack_get_sample_rate(m_pJackClient);
-	jack_nframes_t frame_time = jack_frame_time(m_pJackClient);
+	// Time-stamped (or UMP) datagrams go out as soon as the period
+	// has been captured, with the original timing along the wire...
+	const bool bTimed = (m_pPackets
+		&& m_iWireFormat != qmidinetUdpPacket::Raw);
+
+	// Otherwise, map JACK time onto the monotonic clock, once per
+	// burst, so that each event gets its own absolute deadline...
+	const qint64 clock_offset = m_pRecvThread->clock_nsecs()
+		- qint64(jack_get_time()) * 1000LL;
 
 	while ((pchBuffer = m_pQueueIn->pop(
-			&ev.port, &ev.event.time, &ev.event.size)) != nullptr) {	
+			&ev.port, &ev.event.time, &ev.event.size)) != nullptr) {
 		ev.event.time += m_last_frame_time;
-		if (ev.event.time > frame_time) {
-			unsigned long sleep_time = ev.event.time - frame_time;
-			float secs = float(sleep_time) / sample_rate;
-			if (secs > 0.0001f) {
-			#if 0 // defined(__GNUC__) && defined(Q_OS_LINUX)
-				struct timespec ts;
-				ts.tv_sec  = time_t(secs);
-				ts.tv_nsec = long(1E+9f * (secs - ts.tv_sec));
-				::nanosleep(&ts, nullptr);
-			#else
-				m_pRecvThread->usleep(long(1E+6f * secs));
-			#endif
-			}
-			frame_time = ev.event.time;
-		}	
+		const jack_time_t time
+			= jack_frames_to_time(m_pJackClient, ev.event.time);
 	#ifdef CONFIG_DEBUG
 		// - show (input) event for debug purposes...
 		fprintf(stderr, "JACK MIDI In Port %d: (%d)", ev.port, int(ev.event.size));
@@ -560,18 +867,125 @@ void qmidinetJackMidiDevice::capture (void)
 			fprintf(stderr, " 0x%02x", (unsigned char) pchBuffer[i]);
 		fprintf(stderr, "\n");
 	#endif
-		recvData((unsigned char *) pchBuffer, ev.event.size, ev.port);
+		if (bTimed) {
+			packetData((unsigned char *) pchBuffer,
+				ev.event.size, ev.port, (unsigned long) time);
+		} else {
+			m_pRecvThread->sleep_until(
+				clock_offset + 1000LL * qint64(time), m_spin_time);
+			recvData((unsigned char *) pchBuffer, ev.event.size, ev.port);
+		}
+		// Measure how late it went out...
+		const int delay = int(jack_frame_time(m_pJackClient) - ev.event.time);
+		if (delay > m_delay_in_max.load())
+			m_delay_in_max.store(delay);
+	}
+
+	if (bTimed) {
+		for (int i = 0; i < m_nports; ++i)
+			packetFlush(i);
+	}
+
+	// Notify (once per capture cycle)...
+	if (m_nsent > 0) {
+		m_nsent = 0;
+		emit sending();
+	}
+}
+
+
+// Time-stamped datagram assembly.
+void qmidinetJackMidiDevice::packetData (
+	const unsigned char *data, unsigned short len, int port, unsigned long time )
+{
+	if (port < 0 || port >= m_nports)
+		return;
+
+	qmidinetUdpPacketWriter& packet = m_pPackets[port];
+	if (packet.write(time, data, len))
+		return;
+
+	// Full, send it and start over...
+	packetFlush(port);
+
+	// Too big to fit, send it raw...
+	if (!packet.write(time, data, len))
+		recvData((unsigned char *) data, len, port);
+}
+
+
+void qmidinetJackMidiDevice::packetFlush ( int port )
+{
+	qmidinetUdpPacketWriter& packet = m_pPackets[port];
+	if (!packet.isEmpty()) {
+		recvData(packet.data(), packet.length(), port);
+		packet.clear();
 	}
 }
 
 
+// Capture pacing spin-time accessors (microseconds).
+void qmidinetJackMidiDevice::setSpinTime ( unsigned long spin_time )
+{
+	m_spin_time = spin_time;
+}
+
+unsigned long qmidinetJackMidiDevice::spinTime (void) const
+{
+	return m_spin_time;
+}
+
+
+// Network wire format accessors.
+void qmidinetJackMidiDevice::setWireFormat ( int iWireFormat )
+{
+	m_iWireFormat = iWireFormat;
+
+	// Time-stamped, or else UMP, datagrams...
+	for (int i = 0; m_pPackets && i < m_nports; ++i) {
+		m_pPackets[i].setFormat(
+			qmidinetUdpPacket::Format(m_iWireFormat), i);
+	}
+}
+
+int qmidinetJackMidiDevice::wireFormat (void) const
+{
+	return m_iWireFormat;
+}
+
+
 // JACK specifics.
 int qmidinetJackMidiDevice::process ( jack_nframes_t nframes )
 {
+	const jack_time_t time_start = jack_get_time();
+
 	jack_nframes_t buffer_size = jack_get_buffer_size(m_pJackClient);
 
 	m_last_frame_time = jack_last_frame_time(m_pJackClient);
 
+	unsigned int nevents_total = 0;
+
+	// Output port buffers get cleared first...
+	void *apvBufferOut[m_nports];
+	for (int i = 0; i < m_nports; ++i) {
+		apvBufferOut[i] = nullptr;
+		if (m_ppJackPortOut && m_ppJackPortOut[i]) {
+			apvBufferOut[i] = jack_port_get_buffer(m_ppJackPortOut[i], nframes);
+			jack_midi_clear_buffer(apvBufferOut[i]);
+		}
+	}
+
+	// Network-polled mode: straight from the sockets...
+	if (m_bPolled)
+		nevents_total += pollNetwork(apvBufferOut, nframes, time_start);
+
+	// Make room for the newest, if so chosen...
+	if (m_pJackBufferOut && m_iOverload == DropOldest)
+		dropOldest(m_pJackBufferOut, true);
+
+	const unsigned int fill_out_peak = (m_pJackBufferOut
+		? jack_ringbuffer_read_space(m_pJackBufferOut) : 0);
+
 	// Enqueue/dequeue events
 	// to/from ring-buffers...
 	for (int i = 0; i < m_nports; ++i) {
@@ -580,38 +994,43 @@ int qmidinetJackMidiDevice::process ( jack_nframes_t nframes )
 			void *pvBufferIn
 				= jack_port_get_buffer(m_ppJackPortIn[i], nframes);
 			const int nevents = jack_midi_get_event_count(pvBufferIn);
-			const unsigned int nlimit
+			unsigned int nlimit
 				= jack_ringbuffer_write_space(m_pJackBufferIn);
-			unsigned char  achBuffer[nlimit];
-			unsigned char *pchBuffer = &achBuffer[0];
+			if (nlimit > m_ringbuffer_bytes)
+				nlimit = m_ringbuffer_bytes;
+			unsigned char *pchBuffer = m_pchBufferIn;
 			unsigned int nwrite = 0;
 			for (int n = 0; n < nevents; ++n) {
-				if (nwrite + sizeof(qmidinetJackMidiEvent) >= nlimit)
-					break;
+				jack_midi_event_t event;
+				jack_midi_event_get(&event, pvBufferIn, n);
+				// Overloaded? drop it, but keep count...
+				if (nwrite + sizeof(qmidinetJackMidiEvent)
+						+ event.size >= nlimit
+					|| (isThinning(nlimit - nwrite)
+						&& qmidinetJackMidiDevice_superseded(
+							pvBufferIn, n, nevents, event))) {
+					dropEvent(i, event.size, false);
+					continue;
+				}
 				qmidinetJackMidiEvent *pJackEventIn
 					= (struct qmidinetJackMidiEvent *) pchBuffer;
-				jack_midi_event_get(&pJackEventIn->event, pvBufferIn, n);
-				if (nwrite + sizeof(qmidinetJackMidiEvent)
-					+ pJackEventIn->event.size >= nlimit)
-					break;
+				pJackEventIn->event = event;
 				pJackEventIn->port = i;
 				pchBuffer += sizeof(qmidinetJackMidiEvent);
 				nwrite += sizeof(qmidinetJackMidiEvent);
-				::memcpy(pchBuffer,
-					pJackEventIn->event.buffer, pJackEventIn->event.size);
-				pchBuffer += pJackEventIn->event.size;
-				nwrite += pJackEventIn->event.size;
+				::memcpy(pchBuffer, event.buffer, event.size);
+				pchBuffer += event.size;
+				nwrite += event.size;
 			}
 			if (nwrite > 0) {
 				jack_ringbuffer_write(m_pJackBufferIn,
-					(const char *) achBuffer, nwrite);
+					(const char *) m_pchBufferIn, nwrite);
 			}
+			nevents_total += nevents;
 		}
 	
-		if (m_ppJackPortOut && m_ppJackPortOut[i] && m_pJackBufferOut) {
-			void *pvBufferOut
-				= jack_port_get_buffer(m_ppJackPortOut[i], nframes);
-			jack_midi_clear_buffer(pvBufferOut);
+		if (apvBufferOut[i] && m_pJackBufferOut) {
+			void *pvBufferOut = apvBufferOut[i];
 			const unsigned int nlimit
 				= jack_midi_max_event_size(pvBufferOut);
 			unsigned int nread = 0;
@@ -637,44 +1056,620 @@ int qmidinetJackMidiDevice::process ( jack_nframes_t nframes )
 				else
 				jack_ringbuffer_read_advance(m_pJackBufferOut, ev.event.size);
 				nread += ev.event.size;
+				++nevents_total;
 			}
 		}
 	}
 
-	if (m_pJackBufferIn
-		&& jack_ringbuffer_read_space(m_pJackBufferIn) > 0)
+	const unsigned int fill_in = (m_pJackBufferIn
+		? jack_ringbuffer_read_space(m_pJackBufferIn) : 0);
+	const unsigned int fill_out = (m_pJackBufferOut
+		? jack_ringbuffer_read_space(m_pJackBufferOut) : 0);
+
+	if (fill_in > 0)
 		m_pRecvThread->sync();
 
+	// Keep track of peak bursts (for auto-sizing)...
+	if (m_ringbuffer_peak < fill_in)
+		m_ringbuffer_peak = fill_in;
+	if (m_ringbuffer_peak < fill_out_peak)
+		m_ringbuffer_peak = fill_out_peak;
+
+	// Profile this cycle...
+	const jack_time_t time_last = jack_get_time() - time_start;
+	Profile& prof = m_profile;
+	if (prof.cycles == 0 || prof.time_min > time_last)
+		prof.time_min = time_last;
+	if (prof.time_max < time_last)
+		prof.time_max = time_last;
+	prof.time_sum += time_last;
+	if (prof.period > 0) {
+		unsigned int slot = (unsigned int) ((10 * time_last) / prof.period);
+		if (slot > 10)
+			slot = 10;
+		++prof.hist[slot];
+	}
+	prof.events = nevents_total;
+	prof.fill_in = fill_in;
+	prof.fill_out = fill_out;
+	prof.time_last = time_last;
+	++prof.cycles;
+
 	return 0;
 }
 
 
+// Network-polled mode: non-blocking reads from the network sockets,
+// round-robin, within a hard budget of bytes and time (a quarter of
+// the period) per cycle; then merged fairly and reassembled, per
+// source, straight into the output port buffers.
+unsigned int qmidinetJackMidiDevice::pollNetwork (
+	void **ppvBufferOut, jack_nframes_t nframes, jack_time_t time_start )
+{
+	unsigned int nevents = 0;
+
+#if defined(Q_OS_UNIX)
+
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice == nullptr || nframes < 1)
+		return 0;
+
+	const unsigned int nbytes_max = 8 * qmidinetUdpPacket::MaxSize;
+	const jack_time_t time_max = time_start + (m_profile.period >> 2);
+	const quint64 sample_rate = jack_get_sample_rate(m_pJackClient);
+
+	// Events must go in time order, per port...
+	jack_nframes_t aOffsets[m_nports];
+	for (int i = 0; i < m_nports; ++i)
+		aOffsets[i] = 0;
+
+	qmidinetScheduler& scheduler = pUdpDevice->scheduler();
+
+	unsigned int nbytes = 0;
+	bool bMore = true;
+	while (bMore) {
+		bMore = false;
+		for (int i = 0; i < m_nports; ++i) {
+			const int sockin = pUdpDevice->socketIn(i);
+			if (sockin < 0)
+				continue;
+			// Out of budget?
+			if (nbytes >= nbytes_max || jack_get_time() >= time_max) {
+				++m_profile.polled_limits;
+				bMore = false;
+				break;
+			}
+			// Out of room? Leave it for the next cycle...
+			if (scheduler.isFull(i))
+				continue;
+			unsigned char buf[qmidinetUdpPacket::MaxSize];
+			struct sockaddr_storage sender;
+			socklen_t slen = sizeof(sender);
+			const int r = ::recvfrom(sockin, (char *) buf, sizeof(buf),
+				MSG_DONTWAIT, (struct sockaddr *) &sender, &slen);
+			if (r <= 0)
+				continue;
+			nbytes += r;
+			bMore = true;
+			// Queued per source, for a fair merge...
+			if (sender.ss_family == AF_INET6) {
+				const struct sockaddr_in6 *addr6
+					= (const struct sockaddr_in6 *) &sender;
+				scheduler.enqueue(i,
+					(const unsigned char *) &addr6->sin6_addr, 16,
+					ntohs(addr6->sin6_port), buf, r);
+			} else {
+				const struct sockaddr_in *addr4
+					= (const struct sockaddr_in *) &sender;
+				scheduler.enqueue(i,
+					(const unsigned char *) &addr4->sin_addr, 4,
+					ntohs(addr4->sin_port), buf, r);
+			}
+		}
+	}
+
+	// Network port filtering and routing, onto the output ports...
+	const qmidinetFilter& filter = pUdpDevice->filter();
+	qmidinetDedup& dedup = pUdpDevice->dedup();
+	qmidinetSenders& senders = pUdpDevice->senders();
+
+	for (int i = 0; i < m_nports; ++i) {
+		const unsigned int routes = pUdpDevice->routing().networkToMidi(i);
+		unsigned char buf[qmidinetUdpPacket::MaxSize];
+		unsigned short r = 0;
+		unsigned char addr[16];
+		unsigned short sport = 0;
+		while (scheduler.dequeue(i, buf, &r, addr, &sport)) {
+			// Reassembled, per sender...
+			unsigned char data[qmidinetSenders::MaxSize];
+			const unsigned short n
+				= senders.process(i, addr, sport, buf, r, data);
+			if (n < 1)
+				continue;
+			// Time-stamped events keep their relative timing,
+			// as far as this very cycle goes...
+			qmidinetUdpPacketReader packet(data, n);
+			quint64 usecs = 0;
+			unsigned long delta = 0;
+			const unsigned char *pchData = nullptr;
+			unsigned short len = 0;
+			while (packet.read(&delta, &pchData, &len)) {
+				usecs += delta;
+				if (!filter.accept(pchData, len, i, qmidinetRoutes::Receive))
+					continue;
+				// Echo suppression, never waiting on the
+				// capture threads (skipped on contention)...
+				if (dedup.isActive()) {
+					unsigned int ports = routes;
+					for (int j = 0; ports && j < m_nports; ++j, ports >>= 1) {
+						if (ports & 1)
+							dedup.tryReceived(pchData, len, j);
+					}
+				}
+				const jack_nframes_t frame
+					= jack_nframes_t((usecs * sample_rate) / 1000000ULL);
+				unsigned int mask = routes;
+				for (int j = 0; mask && j < m_nports; ++j, mask >>= 1) {
+					void *pvBufferOut = ppvBufferOut[j];
+					if ((mask & 1) == 0 || pvBufferOut == nullptr)
+						continue;
+					jack_nframes_t offset = frame;
+					if (offset < aOffsets[j])
+						offset = aOffsets[j];
+					if (offset >= nframes)
+						offset = nframes - 1;
+					jack_midi_data_t *pMidiData
+						= jack_midi_event_reserve(pvBufferOut, offset, len);
+					if (pMidiData) {
+						::memcpy(pMidiData, pchData, len);
+						aOffsets[j] = offset;
+						++nevents;
+					}
+					else dropEvent(j, len, true);
+				}
+			}
+		}
+	}
+
+	m_profile.polled_bytes += nbytes;
+
+#endif	// Q_OS_UNIX
+
+	return nevents;
+}
+
+
+// Network-polled mode accessors.
+void qmidinetJackMidiDevice::setNetworkPolled ( bool bPolled )
+{
+	m_bPolled = bPolled;
+}
+
+bool qmidinetJackMidiDevice::isNetworkPolled (void) const
+{
+	return m_bPolled;
+}
+
+
 void qmidinetJackMidiDevice::shutdownNotify (void)
 {
 	emit shutdown();
 }
 
 
+// Port connections change: take a snapshot later, off this thread.
+void qmidinetJackMidiDevice::connectNotify (void)
+{
+	if (!m_connects_dirty.exchange(true))
+		QMetaObject::invokeMethod(this, "connectUpdate", Qt::QueuedConnection);
+}
+
+
+// Port connections snapshot slot.
+void qmidinetJackMidiDevice::connectUpdate (void)
+{
+	m_connects_dirty.store(false);
+
+	if (m_pJackClient == nullptr)
+		return;
+
+	QHash<QString, QStringList> connects;
+
+	for (int i = 0; i < m_nports; ++i) {
+		jack_port_t *ports[2] = {
+			(m_ppJackPortIn  ? m_ppJackPortIn[i]  : nullptr),
+			(m_ppJackPortOut ? m_ppJackPortOut[i] : nullptr)
+		};
+		for (int j = 0; j < 2; ++j) {
+			if (ports[j] == nullptr)
+				continue;
+			const char **ppszPorts
+				= jack_port_get_all_connections(m_pJackClient, ports[j]);
+			if (ppszPorts == nullptr)
+				continue;
+			QStringList& peers
+				= connects[QString::fromLocal8Bit(jack_port_short_name(ports[j]))];
+			for (int k = 0; ppszPorts[k]; ++k)
+				peers.append(QString::fromLocal8Bit(ppszPorts[k]));
+			peers.sort();
+			jack_free(ppszPorts);
+		}
+	}
+
+	// Anything other than what we've restored so far? then the
+	// connections were changed meanwhile: stop restoring the rest...
+	if (!m_restores.isEmpty() && connects != m_connects) {
+		m_restores.clear();
+		m_reconnect_timer.stop();
+	}
+
+	m_connects = connects;
+}
+
+
+// Automatic reconnection (after server shutdown).
+void qmidinetJackMidiDevice::reconnect (void)
+{
+	close();
+
+	// Keep the last connections, to be restored
+	// (along with any not restored yet, if any)...
+	QHash<QString, QStringList>::ConstIterator iter = m_connects.constBegin();
+	for ( ; iter != m_connects.constEnd(); ++iter) {
+		QStringList& peers = m_restores[iter.key()];
+		for (const QString& sPeer : iter.value()) {
+			if (!peers.contains(sPeer))
+				peers.append(sPeer);
+		}
+	}
+	m_connects.clear();
+
+	if (!m_sClientName.isEmpty() && m_iNumPorts > 0)
+		m_reconnect_timer.start();
+}
+
+
+// Automatic reconnection retry slot.
+void qmidinetJackMidiDevice::reconnectTimeout (void)
+{
+	// Never (re)start the server on our own...
+	if (m_pJackClient == nullptr) {
+		if (!openClient(JackNoStartServer))
+			return;
+		emit reconnected();
+	}
+
+	// Keep trying while any peers are still missing
+	// (eg. a2jmidid or a synth, restarting after jackd)...
+	if (restoreConnections())
+		m_reconnect_timer.stop();
+}
+
+
+// Restore port connections (after reconnection).
+bool qmidinetJackMidiDevice::restoreConnections (void)
+{
+	if (m_pJackClient == nullptr)
+		return false;
+
+	for (int i = 0; i < m_nports; ++i) {
+		jack_port_t *ports[2] = {
+			(m_ppJackPortIn  ? m_ppJackPortIn[i]  : nullptr),
+			(m_ppJackPortOut ? m_ppJackPortOut[i] : nullptr)
+		};
+		for (int j = 0; j < 2; ++j) {
+			if (ports[j] == nullptr)
+				continue;
+			const QString& sPort
+				= QString::fromLocal8Bit(jack_port_short_name(ports[j]));
+			if (!m_restores.contains(sPort))
+				continue;
+			const char *pszPort = jack_port_name(ports[j]);
+			QStringList& peers = m_restores[sPort];
+			QStringList::Iterator iter = peers.begin();
+			while (iter != peers.end()) {
+				const QByteArray aPeer = (*iter).toLocal8Bit();
+				const char *pszPeer = aPeer.constData();
+				// Not back yet? try again later...
+				if (jack_port_by_name(m_pJackClient, pszPeer) == nullptr) {
+					++iter;
+					continue;
+				}
+				if (!jack_port_connected_to(ports[j], pszPeer)
+					&& (j == 0
+						? jack_connect(m_pJackClient, pszPeer, pszPort)
+						: jack_connect(m_pJackClient, pszPort, pszPeer)) != 0) {
+					++iter;
+					continue;
+				}
+				QStringList& connects = m_connects[sPort];
+				if (!connects.contains(*iter)) {
+					connects.append(*iter);
+					connects.sort();
+				}
+				iter = peers.erase(iter);
+			}
+			if (peers.isEmpty())
+				m_restores.remove(sPort);
+		}
+	}
+
+	return m_restores.isEmpty();
+}
+
+
+// XRun correlation: snapshot of last cycle bridge activity.
+void qmidinetJackMidiDevice::xrunNotify (void)
+{
+	Profile& prof = m_profile;
+	++prof.xruns;
+	if (prof.events > 0 || prof.fill_in > 0 || prof.fill_out > 0)
+		++prof.xruns_busy;
+	prof.xrun_events = prof.events;
+	prof.xrun_fill_in = prof.fill_in;
+	prof.xrun_fill_out = prof.fill_out;
+	prof.xrun_time = prof.time_last;
+}
+
+
+// Buffer-size changes: histogram is relative to the period.
+void qmidinetJackMidiDevice::bufferSizeNotify ( jack_nframes_t nframes )
+{
+	if (m_pJackClient == nullptr)
+		return;
+
+	const jack_nframes_t sample_rate = jack_get_sample_rate(m_pJackClient);
+	if (sample_rate > 0)
+		m_profile.period = (jack_time_t(nframes) * 1000000ULL) / sample_rate;
+
+	for (int i = 0; i < 11; ++i)
+		m_profile.hist[i] = 0;
+}
+
+
+// Runtime statistics (human readable).
+QString qmidinetJackMidiDevice::statistics (void) const
+{
+	QString sText;
+
+	if (m_pJackClient == nullptr)
+		return sText;
+
+	// Take a snapshot (may be a little off)...
+	const Profile prof = m_profile;
+
+	sText += tr("JACK process: %1 cycles, period %2 usecs.\n")
+		.arg(prof.cycles).arg(prof.period);
+	if (prof.cycles > 0) {
+		sText += tr("Process time: min %1, avg %2, max %3 usecs.\n")
+			.arg(prof.time_min)
+			.arg(prof.time_sum / prof.cycles)
+			.arg(prof.time_max);
+		sText += tr("Process load (%1 of period):").arg('%');
+		for (int i = 0; i < 10; ++i) {
+			if (prof.hist[i] > 0)
+				sText += QString(" %1-%2%: %3")
+					.arg(10 * i).arg(10 * (i + 1)).arg(prof.hist[i]);
+		}
+		if (prof.hist[10] > 0)
+			sText += tr(" overrun: %1").arg(prof.hist[10]);
+		sText += '\n';
+	}
+	sText += tr("XRuns: %1 (%2 with bridge activity).\n")
+		.arg(prof.xruns).arg(prof.xruns_busy);
+	if (prof.xruns > 0) {
+		sText += tr("Last XRun: %1 events, %2/%3 bytes queued (in/out), "
+			"%4 usecs process time.\n")
+			.arg(prof.xrun_events)
+			.arg(prof.xrun_fill_in)
+			.arg(prof.xrun_fill_out)
+			.arg(prof.xrun_time);
+	}
+
+	if (m_bPolled) {
+		sText += tr("Network polled: %1 bytes, %2 cycles out of budget.\n")
+			.arg(prof.polled_bytes).arg(prof.polled_limits);
+	}
+	sText += tr("Ring-buffers: %1 bytes, peak %2 bytes.\n")
+		.arg(m_ringbuffer_bytes).arg(m_ringbuffer_peak);
+	for (int i = 0; m_pDrops && i < m_nports; ++i) {
+		const Drops& drops = m_pDrops[i];
+		const unsigned long events_in = drops.events_in.load();
+		const unsigned long events_out = drops.events_out.load();
+		if (events_in > 0 || events_out > 0) {
+			sText += tr("Port %1 dropped: in %2 events (%3 bytes), "
+				"out %4 events (%5 bytes).\n").arg(i + 1)
+				.arg(events_in).arg(drops.bytes_in.load())
+				.arg(events_out).arg(drops.bytes_out.load());
+		}
+	}
+
+	return sText;
+}
+
+
+// Port latency ranges: network plus bridge latencies.
+void qmidinetJackMidiDevice::latencyNotify ( jack_latency_callback_mode_t mode )
+{
+	if (m_pJackClient == nullptr)
+		return;
+
+	const jack_nframes_t latency = jack_nframes_t(
+		(quint64(m_latency) * jack_get_sample_rate(m_pJackClient)) / 1000ULL);
+
+	jack_latency_range_t range;
+	if (mode == JackCaptureLatency) {
+		// Network to JACK (out_N)...
+		range.min = range.max = latency + m_latency_out;
+		for (int i = 0; i < m_nports; ++i) {
+			if (m_ppJackPortOut && m_ppJackPortOut[i])
+				jack_port_set_latency_range(m_ppJackPortOut[i], mode, &range);
+		}
+	} else {
+		// JACK to network (in_N)...
+		range.min = range.max = latency + m_latency_in;
+		for (int i = 0; i < m_nports; ++i) {
+			if (m_ppJackPortIn && m_ppJackPortIn[i])
+				jack_port_set_latency_range(m_ppJackPortIn[i], mode, &range);
+		}
+	}
+}
+
+
+// Port latency (re)measurement slot.
+void qmidinetJackMidiDevice::latencyUpdate (void)
+{
+	if (m_pJackClient == nullptr)
+		return;
+
+	// Capture (JACK to network) is measured from each event's own
+	// frame time to the moment it's actually sent, plus one period;
+	// keep last measured when there's no traffic...
+	const int buffer_size = int(jack_get_buffer_size(m_pJackClient));
+	int delay_in = m_delay_in_max.exchange(0);
+	if (delay_in > 0)
+		delay_in += buffer_size;
+	else
+		delay_in = int(m_latency_in);
+
+	// Playback (network to JACK) is scheduled exactly one period
+	// behind the arrival (or sender's) timing, so that's reported;
+	// late events are not accounted for here.
+	const int delay_out = buffer_size;
+
+	if (jack_nframes_t(delay_in) != m_latency_in
+		|| jack_nframes_t(delay_out) != m_latency_out) {
+		m_latency_in  = delay_in;
+		m_latency_out = delay_out;
+		jack_recompute_total_latencies(m_pJackClient);
+	}
+}
+
+
+// Network latency accessors (milliseconds).
+void qmidinetJackMidiDevice::setLatency ( unsigned int latency )
+{
+	if (m_latency == latency)
+		return;
+
+	m_latency = latency;
+
+	if (m_pJackClient)
+		jack_recompute_total_latencies(m_pJackClient);
+}
+
+unsigned int qmidinetJackMidiDevice::latency (void) const
+{
+	return m_latency;
+}
+
+
+// Ring-buffer capacity accessors (bytes per port; 0 = auto).
+void qmidinetJackMidiDevice::setRingBufferSize ( unsigned int ringbuffer_size )
+{
+	m_ringbuffer_size = ringbuffer_size;
+}
+
+unsigned int qmidinetJackMidiDevice::ringBufferSize (void) const
+{
+	return m_ringbuffer_size;
+}
+
+
+// Overload policy accessors.
+void qmidinetJackMidiDevice::setOverload ( int iOverload )
+{
+	m_iOverload = iOverload;
+}
+
+int qmidinetJackMidiDevice::overload (void) const
+{
+	return m_iOverload;
+}
+
+
+// Overload handling: account for a dropped event.
+void qmidinetJackMidiDevice::dropEvent (
+	int port, unsigned int size, bool bOut ) const
+{
+	if (m_pDrops == nullptr || port < 0 || port >= m_nports)
+		return;
+
+	Drops& drops = m_pDrops[port];
+	if (bOut) {
+		drops.events_out.fetch_add(1);
+		drops.bytes_out.fetch_add(size);
+	} else {
+		drops.events_in.fetch_add(1);
+		drops.bytes_in.fetch_add(size);
+	}
+}
+
+
+// Overload handling: the consumer side evicts the oldest events,
+// from the high-water mark (3/4) down to the low-water mark (1/2),
+// so that the newest ones may still get in.
+void qmidinetJackMidiDevice::dropOldest (
+	jack_ringbuffer_t *pJackBuffer, bool bOut )
+{
+	const unsigned int nhigh = (3 * m_ringbuffer_bytes) >> 2;
+	const unsigned int nlow  = (m_ringbuffer_bytes >> 1);
+
+	if (jack_ringbuffer_read_space(pJackBuffer) < nhigh)
+		return;
+
+	qmidinetJackMidiEvent ev;
+	while (jack_ringbuffer_read_space(pJackBuffer) > nlow
+		&& jack_ringbuffer_peek(pJackBuffer,
+			(char *) &ev, sizeof(ev)) == sizeof(ev)) {
+		jack_ringbuffer_read_advance(pJackBuffer,
+			sizeof(ev) + ev.event.size);
+		dropEvent(ev.port, ev.event.size, bOut);
+	}
+}
+
+
+// Overload handling: whether continuous controller updates get
+// thinned out, when below the low-water mark (1/4).
+bool qmidinetJackMidiDevice::isThinning ( unsigned int write_space ) const
+{
+	return (m_iOverload == ThinControllers
+		&& write_space < (m_ringbuffer_bytes >> 2));
+}
+
+
 // Data transmission methods.
 bool qmidinetJackMidiDevice::sendData (
 	unsigned char *data, unsigned short len, int port ) const
+{
+	if (m_pJackClient == nullptr)
+		return false;
+
+	return sendEvent(data, len, port, jack_frame_time(m_pJackClient));
+}
+
+
+// Time-stamped event transmission.
+bool qmidinetJackMidiDevice::sendEvent ( const unsigned char *data,
+	unsigned short len, int port, jack_nframes_t time ) const
 {
 	if (port < 0 || port >= m_nports)
 		return false;
 
-	if (m_pJackBufferOut == nullptr)
+	if (m_pJackBufferOut == nullptr || m_pchBufferOut == nullptr)
 		return false;
 
-	const unsigned int nlimit
+	unsigned int nlimit
 		= jack_ringbuffer_write_space(m_pJackBufferOut);
+	if (nlimit > m_ringbuffer_bytes)
+		nlimit = m_ringbuffer_bytes;
 	if (sizeof(qmidinetJackMidiEvent) + len < nlimit) {
-		unsigned char  achBuffer[nlimit];
-		unsigned char *pchBuffer = &achBuffer[0];
+		unsigned char *pchBuffer = m_pchBufferOut;
 		qmidinetJackMidiEvent *pJackEventOut
 			= (struct qmidinetJackMidiEvent *) pchBuffer;
 		pchBuffer += sizeof(qmidinetJackMidiEvent);
 		memcpy(pchBuffer, data, len);
-		pJackEventOut->event.time = jack_frame_time(m_pJackClient);
+		pJackEventOut->event.time = time;
 		pJackEventOut->event.buffer = (jack_midi_data_t *) pchBuffer;
 		pJackEventOut->event.size = len;
 		pJackEventOut->port = port;
@@ -686,24 +1681,57 @@ bool qmidinetJackMidiDevice::sendData (
 		fprintf(stderr, "\n");
 	#endif
 		jack_ringbuffer_write(m_pJackBufferOut,
-			(const char *) achBuffer, sizeof(qmidinetJackMidiEvent) + len);
+			(const char *) m_pchBufferOut, sizeof(qmidinetJackMidiEvent) + len);
+		return true;
 	}
 
-	return true;
+	// Overloaded, drop it...
+	dropEvent(port, len, true);
+	return false;
 }
 
 
 void qmidinetJackMidiDevice::recvData (
 	unsigned char *data, unsigned short len, int port )
 {
-	emit received(QByteArray((const char *) data, len), port);
+	// Send straight to the network, from this very thread...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice && pUdpDevice->sendData(data, len, port, this))
+		++m_nsent;
 }
 
 
 // Receive data slot.
 void qmidinetJackMidiDevice::receive ( QByteArray data, int port )
 {
-	sendData((unsigned char *) data.constData(), data.length(), port);
+	if (m_pJackClient == nullptr)
+		return;
+
+	qmidinetUdpPacketReader packet(
+		(const unsigned char *) data.constData(), data.length());
+
+	// Restore the original timing, relative to now; raw datagrams
+	// get split into single messages, as one JACK MIDI event each...
+	const quint64 sample_rate = jack_get_sample_rate(m_pJackClient);
+	const jack_nframes_t frame_time = jack_frame_time(m_pJackClient);
+	const bool bThinning = (m_pJackBufferOut
+		&& isThinning(jack_ringbuffer_write_space(m_pJackBufferOut)));
+	quint64 usecs = 0;
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short len = 0;
+	while (packet.read(&delta, &pchData, &len)) {
+		usecs += delta;
+		// Overloaded? drop superseded controller values, if so chosen...
+		if (bThinning && port >= 0 && port < m_nports
+			&& qmidinetJackMidiDevice_superseded(packet, pchData, len)) {
+			dropEvent(port, len, true);
+			continue;
+		}
+		const jack_nframes_t frames
+			= jack_nframes_t((usecs * sample_rate) / 1000000ULL);
+		sendEvent(pchData, len, port, frame_time + frames);
+	}
 }
 
 
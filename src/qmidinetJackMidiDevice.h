@@ -23,6 +23,7 @@
 #define __qmidinetJackMidiDevice_h
 
 #include "qmidinetAbout.h"
+#include "qmidinetMidiDevice.h"
 
 #ifdef CONFIG_JACK_MIDI
 
@@ -35,17 +36,25 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QTimer>
+
+#include <atomic>
 
 
 //----------------------------------------------------------------------------
 // qmidinetJackMidiDevice -- JACK MIDI interface object.
 
-class qmidinetJackMidiDevice : public QObject
+class qmidinetJackMidiDevice : public qmidinetMidiDevice
 {
 	Q_OBJECT
 
 public:
 
+	// Overload policies.
+	enum Overload { DropNewest = 0, DropOldest = 1, ThinControllers = 2 };
+
 	// Constructor.
 	qmidinetJackMidiDevice(QObject *pParent = nullptr);
 
@@ -68,29 +77,117 @@ public:
 	bool sendData(unsigned char *data, unsigned short len, int port = 0) const;
 	void recvData(unsigned char *data, unsigned short len, int port = 0);
 
+	// Capture pacing spin-time accessors (microseconds).
+	void setSpinTime(unsigned long spin_time);
+	unsigned long spinTime() const;
+
+	// Network wire format accessors.
+	void setWireFormat(int iWireFormat);
+	int wireFormat() const;
+
+	// Network latency accessors (milliseconds).
+	void setLatency(unsigned int latency);
+	unsigned int latency() const;
+
+	// Ring-buffer capacity accessors (bytes per port; 0 = auto).
+	void setRingBufferSize(unsigned int ringbuffer_size);
+	unsigned int ringBufferSize() const;
+
+	// Overload policy accessors.
+	void setOverload(int iOverload);
+	int overload() const;
+
+	// Network-polled mode accessors.
+	void setNetworkPolled(bool bPolled);
+	bool isNetworkPolled() const;
+
 	// JACK specifics.
 	int process (jack_nframes_t nframes);
 
 	void shutdownNotify();
 
-signals:
+	void connectNotify();
+
+	// Automatic reconnection (after server shutdown).
+	void reconnect();
+
+	void latencyNotify(jack_latency_callback_mode_t mode);
 
-	// Received data signal.
-	void received(QByteArray data, int port);
+	void xrunNotify();
+	void bufferSizeNotify(jack_nframes_t nframes);
+
+	// Runtime statistics (human readable).
+	QString statistics() const;
+
+signals:
 
 	// Shutdown signal.
 	void shutdown();
+
+	// Reconnected (after shutdown) signal.
+	void reconnected();
 	
 public slots:
 
 	// Receive data slot.
 	void receive(QByteArray data, int port);
 
+protected slots:
+
+	// Port latency (re)measurement slot.
+	void latencyUpdate();
+
+	// Port connections snapshot slot.
+	void connectUpdate();
+
+	// Automatic reconnection retry slot.
+	void reconnectTimeout();
+
+protected:
+
+	// Device client (re)initialization method.
+	bool openClient(jack_options_t options);
+
+	// Restore port connections (after reconnection);
+	// returns whether there's none left to restore.
+	bool restoreConnections();
+
+	// Time-stamped event transmission.
+	bool sendEvent(const unsigned char *data, unsigned short len,
+		int port, jack_nframes_t time) const;
+
+	// Time-stamped datagram assembly.
+	void packetData(const unsigned char *data, unsigned short len,
+		int port, unsigned long time);
+	void packetFlush(int port);
+
+	// Network-polled mode: read straight into the output ports.
+	unsigned int pollNetwork(void **ppvBufferOut,
+		jack_nframes_t nframes, jack_time_t time_start);
+
+	// Overload handling.
+	void dropEvent(int port, unsigned int size, bool bOut) const;
+	void dropOldest(jack_ringbuffer_t *pJackBuffer, bool bOut);
+	bool isThinning(unsigned int write_space) const;
+
 private:
 
 	// Instance variables,
 	int m_nports;
 
+	// Client name and number of ports (as last opened).
+	QString m_sClientName;
+	int     m_iNumPorts;
+
+	// Port connections (peer port names per own port name).
+	QHash<QString, QStringList> m_connects;
+	std::atomic<bool> m_connects_dirty;
+
+	// Port connections still to be restored (after reconnection).
+	QHash<QString, QStringList> m_restores;
+
+	QTimer m_reconnect_timer;
+
 	// Instance variables.
 	jack_client_t *m_pJackClient;
 
@@ -100,8 +197,89 @@ private:
 	jack_ringbuffer_t *m_pJackBufferIn;
 	jack_ringbuffer_t *m_pJackBufferOut;
 
+	// Event scratch buffers (ring-buffer capacity).
+	unsigned char *m_pchBufferIn;
+	unsigned char *m_pchBufferOut;
+
 	jack_nframes_t m_last_frame_time;
-	
+
+	unsigned long m_spin_time;
+
+	// Network wire format.
+	int m_iWireFormat;
+
+	// Time-stamped datagrams (per port).
+	class qmidinetUdpPacketWriter *m_pPackets;
+
+	// Sent datagrams (per capture cycle).
+	unsigned int m_nsent;
+
+	// Port latencies (network and bridge, in frames).
+	unsigned int m_latency;
+
+	jack_nframes_t m_latency_in;
+	jack_nframes_t m_latency_out;
+
+	std::atomic<int> m_delay_in_max;
+
+	QTimer m_latency_timer;
+
+	// Ring-buffer capacity (configured per port, actual overall).
+	unsigned int m_ringbuffer_size;
+	unsigned int m_ringbuffer_bytes;
+
+	// Ring-buffer peak fill, as observed (survives re-opening).
+	unsigned int m_ringbuffer_peak;
+
+	// Overload policy.
+	int m_iOverload;
+
+	// Dropped event/byte counters (per port).
+	struct Drops
+	{
+		std::atomic<unsigned long> events_in;
+		std::atomic<unsigned long> bytes_in;
+		std::atomic<unsigned long> events_out;
+		std::atomic<unsigned long> bytes_out;
+	};
+
+	Drops *m_pDrops;
+
+	// Network-polled mode.
+	bool m_bPolled;
+
+	// Process-cycle profiler (microseconds).
+	struct Profile
+	{
+		unsigned long cycles;
+		jack_time_t   time_min;
+		jack_time_t   time_max;
+		jack_time_t   time_sum;
+		jack_time_t   period;
+
+		// Histogram of 10% period slots, plus overruns.
+		unsigned long hist[11];
+
+		// Last cycle bridge activity.
+		unsigned int  events;
+		unsigned int  fill_in;
+		unsigned int  fill_out;
+		jack_time_t   time_last;
+
+		// XRun correlation.
+		unsigned long xruns;
+		unsigned long xruns_busy;
+		unsigned int  xrun_events;
+		unsigned int  xrun_fill_in;
+		unsigned int  xrun_fill_out;
+		jack_time_t   xrun_time;
+
+		// Network-polled mode.
+		unsigned long polled_bytes;
+		unsigned long polled_limits;
+
+	} m_profile;
+
 	// Queue sorter.
 	class qmidinetJackMidiQueue *m_pQueueIn;
 
@@ -0,0 +1,94 @@
+// qmidinetLoopbackMidiDevice.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetLoopbackMidiDevice.h"
+
+#include "qmidinetUdpDevice.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetLoopbackMidiDevice -- MIDI backend loopback (in-process).
+
+// Constructor.
+qmidinetLoopbackMidiDevice::qmidinetLoopbackMidiDevice ( QObject *pParent )
+	: qmidinetMidiDevice(pParent), m_nports(0),
+		m_ndatagrams(0), m_nbytes(0), m_nerrors(0)
+{
+}
+
+
+// Backend factory method.
+qmidinetMidiDevice *qmidinetLoopbackMidiDevice::create ( QObject *pParent )
+{
+	return new qmidinetLoopbackMidiDevice(pParent);
+}
+
+
+// Device initialization method.
+bool qmidinetLoopbackMidiDevice::open (
+	const QString& /*sClientName*/, int iNumPorts )
+{
+	close();
+
+	m_nports = iNumPorts;
+
+	return true;
+}
+
+
+// Device termination method.
+void qmidinetLoopbackMidiDevice::close (void)
+{
+	m_nports = 0;
+	m_ndatagrams = 0;
+	m_nbytes = 0;
+	m_nerrors = 0;
+}
+
+
+// Runtime statistics (human readable).
+QString qmidinetLoopbackMidiDevice::statistics (void) const
+{
+	return tr("Loopback: %1 datagrams, %2 bytes looped back (%3 failed).\n")
+		.arg(m_ndatagrams).arg(m_nbytes).arg(m_nerrors);
+}
+
+
+// Receive data slot.
+void qmidinetLoopbackMidiDevice::receive ( QByteArray data, int port )
+{
+	if (port < 0 || port >= m_nports)
+		return;
+
+	// Right back to the network (multicast loopback is off,
+	// so this won't ever be received here again)...
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
+	if (pUdpDevice && pUdpDevice->sendData(
+			(unsigned char *) data.data(), data.length(), port)) {
+		++m_ndatagrams;
+		m_nbytes += data.length();
+		emit sending();
+	}
+	else ++m_nerrors;
+}
+
+
+// end of qmidinetLoopbackMidiDevice.cpp
@@ -0,0 +1,75 @@
+// qmidinetLoopbackMidiDevice.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetLoopbackMidiDevice_h
+#define __qmidinetLoopbackMidiDevice_h
+
+#include "qmidinetMidiDevice.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetLoopbackMidiDevice -- MIDI backend loopback (in-process).
+//
+// Whatever comes from the network goes right back to it, as it is,
+// on the very same port; a reflector for peers to measure and stress
+// the network path against. Needs no sound server at all.
+
+class qmidinetLoopbackMidiDevice : public qmidinetMidiDevice
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetLoopbackMidiDevice(QObject *pParent = nullptr);
+
+	// Backend factory method.
+	static qmidinetMidiDevice *create(QObject *pParent);
+
+	// Device initialization method.
+	bool open(const QString& sClientName, int iNumPorts = 1);
+
+	// Device termination method.
+	void close();
+
+	// Runtime statistics (human readable).
+	QString statistics() const;
+
+public slots:
+
+	// Receive data slot.
+	void receive(QByteArray data, int port);
+
+private:
+
+	// Instance variables.
+	int m_nports;
+
+	// Looped back counters.
+	unsigned long m_ndatagrams;
+	unsigned long m_nbytes;
+	unsigned long m_nerrors;
+};
+
+
+#endif	// __qmidinetLoopbackMidiDevice_h
+
+// end of qmidinetLoopbackMidiDevice.h
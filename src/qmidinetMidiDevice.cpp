@@ -0,0 +1,96 @@
+// qmidinetMidiDevice.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetMidiDevice.h"
+
+#include "qmidinetNullMidiDevice.h"
+#include "qmidinetLoopbackMidiDevice.h"
+
+#include <QMap>
+
+
+//----------------------------------------------------------------------------
+// qmidinetMidiDevice -- MIDI backend interface (abstract).
+
+// Constructor.
+qmidinetMidiDevice::qmidinetMidiDevice ( QObject *pParent )
+	: QObject(pParent)
+{
+}
+
+
+// Destructor.
+qmidinetMidiDevice::~qmidinetMidiDevice (void)
+{
+}
+
+
+// Runtime statistics (human readable; empty if none).
+QString qmidinetMidiDevice::statistics (void) const
+{
+	return QString();
+}
+
+
+// Backend registry (built-in ones registered on first use).
+typedef QMap<QString, qmidinetMidiDevice::CreateFunc> qmidinetMidiDeviceRegistry;
+
+static qmidinetMidiDeviceRegistry& qmidinetMidiDevice_registry (void)
+{
+	static qmidinetMidiDeviceRegistry s_registry;
+
+	if (s_registry.isEmpty()) {
+		s_registry.insert("null", qmidinetNullMidiDevice::create);
+		s_registry.insert("loopback", qmidinetLoopbackMidiDevice::create);
+	}
+
+	return s_registry;
+}
+
+
+// Backend registry methods.
+void qmidinetMidiDevice::registerDevice (
+	const QString& sName, CreateFunc pfnCreate )
+{
+	qmidinetMidiDeviceRegistry& registry = qmidinetMidiDevice_registry();
+	if (pfnCreate)
+		registry.insert(sName, pfnCreate);
+	else
+		registry.remove(sName);
+}
+
+
+QStringList qmidinetMidiDevice::deviceNames (void)
+{
+	return qmidinetMidiDevice_registry().keys();
+}
+
+
+qmidinetMidiDevice *qmidinetMidiDevice::createDevice (
+	const QString& sName, QObject *pParent )
+{
+	const CreateFunc pfnCreate
+		= qmidinetMidiDevice_registry().value(sName, nullptr);
+	return (pfnCreate ? (*pfnCreate)(pParent) : nullptr);
+}
+
+
+// end of qmidinetMidiDevice.cpp
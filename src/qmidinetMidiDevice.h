@@ -0,0 +1,82 @@
+// qmidinetMidiDevice.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetMidiDevice_h
+#define __qmidinetMidiDevice_h
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+
+//----------------------------------------------------------------------------
+// qmidinetMidiDevice -- MIDI backend interface (abstract).
+//
+// Backends take datagrams as received from the network (receive slot)
+// and send their own captured data straight to it, notifying each time
+// (sending signal). Some are built-in; others may be created by name,
+// through the run-time registry.
+
+class qmidinetMidiDevice : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetMidiDevice(QObject *pParent = nullptr);
+
+	// Destructor.
+	virtual ~qmidinetMidiDevice();
+
+	// Device initialization method.
+	virtual bool open(const QString& sClientName, int iNumPorts = 1) = 0;
+
+	// Device termination method.
+	virtual void close() = 0;
+
+	// Runtime statistics (human readable; empty if none).
+	virtual QString statistics() const;
+
+	// Backend factory method type.
+	typedef qmidinetMidiDevice *(*CreateFunc)(QObject *pParent);
+
+	// Backend registry methods.
+	static void registerDevice(const QString& sName, CreateFunc pfnCreate);
+	static QStringList deviceNames();
+	static qmidinetMidiDevice *createDevice(
+		const QString& sName, QObject *pParent = nullptr);
+
+signals:
+
+	// Sent data (to network) signal.
+	void sending();
+
+public slots:
+
+	// Receive data slot.
+	virtual void receive(QByteArray data, int port) = 0;
+};
+
+
+#endif	// __qmidinetMidiDevice_h
+
+// end of qmidinetMidiDevice.h
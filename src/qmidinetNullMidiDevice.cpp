@@ -0,0 +1,81 @@
+// qmidinetNullMidiDevice.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetNullMidiDevice.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetNullMidiDevice -- MIDI backend sink (null).
+
+// Constructor.
+qmidinetNullMidiDevice::qmidinetNullMidiDevice ( QObject *pParent )
+	: qmidinetMidiDevice(pParent), m_nports(0), m_ndatagrams(0), m_nbytes(0)
+{
+}
+
+
+// Backend factory method.
+qmidinetMidiDevice *qmidinetNullMidiDevice::create ( QObject *pParent )
+{
+	return new qmidinetNullMidiDevice(pParent);
+}
+
+
+// Device initialization method.
+bool qmidinetNullMidiDevice::open ( const QString& /*sClientName*/, int iNumPorts )
+{
+	close();
+
+	m_nports = iNumPorts;
+
+	return true;
+}
+
+
+// Device termination method.
+void qmidinetNullMidiDevice::close (void)
+{
+	m_nports = 0;
+	m_ndatagrams = 0;
+	m_nbytes = 0;
+}
+
+
+// Runtime statistics (human readable).
+QString qmidinetNullMidiDevice::statistics (void) const
+{
+	return tr("Null: %1 datagrams, %2 bytes received.\n")
+		.arg(m_ndatagrams).arg(m_nbytes);
+}
+
+
+// Receive data slot.
+void qmidinetNullMidiDevice::receive ( QByteArray data, int port )
+{
+	if (port < 0 || port >= m_nports)
+		return;
+
+	++m_ndatagrams;
+	m_nbytes += data.length();
+}
+
+
+// end of qmidinetNullMidiDevice.cpp
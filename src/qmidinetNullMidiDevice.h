@@ -0,0 +1,73 @@
+// qmidinetNullMidiDevice.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetNullMidiDevice_h
+#define __qmidinetNullMidiDevice_h
+
+#include "qmidinetMidiDevice.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetNullMidiDevice -- MIDI backend sink (null).
+//
+// Whatever comes from the network is counted and discarded; nothing
+// is ever sent. Needs no sound server at all.
+
+class qmidinetNullMidiDevice : public qmidinetMidiDevice
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetNullMidiDevice(QObject *pParent = nullptr);
+
+	// Backend factory method.
+	static qmidinetMidiDevice *create(QObject *pParent);
+
+	// Device initialization method.
+	bool open(const QString& sClientName, int iNumPorts = 1);
+
+	// Device termination method.
+	void close();
+
+	// Runtime statistics (human readable).
+	QString statistics() const;
+
+public slots:
+
+	// Receive data slot.
+	void receive(QByteArray data, int port);
+
+private:
+
+	// Instance variables.
+	int m_nports;
+
+	// Received counters.
+	unsigned long m_ndatagrams;
+	unsigned long m_nbytes;
+};
+
+
+#endif	// __qmidinetNullMidiDevice_h
+
+// end of qmidinetNullMidiDevice.h
@@ -24,12 +24,12 @@
 
 #include <QTextStream>
 
-#include <QApplication>
+#include <QCoreApplication>
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
 #include <QCommandLineParser>
 #include <QCommandLineOption>
-#if defined(Q_OS_WINDOWS)
+#if defined(Q_OS_WINDOWS) && defined(QT_WIDGETS_LIB)
 #include <QMessageBox>
 #endif
 #endif
@@ -81,6 +81,7 @@ void qmidinetOptions::loadOptions (void)
 	iNumPorts = m_settings.value("/NumPorts", 1).toInt();
 	bAlsaMidi = m_settings.value("/AlsaMidi", true).toBool();
 	bJackMidi = m_settings.value("/JackMidi", false).toBool();
+	backends = m_settings.value("/Backends").toStringList();
 	m_settings.endGroup();
 
 	// Network specific options...
@@ -88,6 +89,32 @@ void qmidinetOptions::loadOptions (void)
 	sInterface = m_settings.value("/Interface").toString();
 	sUdpAddr = m_settings.value("/UdpAddr", QMIDINET_UDP_IPV4_ADDR).toString();
 	iUdpPort = m_settings.value("/UdpPort", QMIDINET_UDP_PORT).toInt();
+	iWireFormat = m_settings.value("/WireFormat", 0).toInt();
+	routes = m_settings.value("/Routes").toStringList();
+	filters = m_settings.value("/Filters").toStringList();
+	priorities = m_settings.value("/Priorities").toStringList();
+	iThinRate = m_settings.value("/ThinRate", 0).toInt();
+	bThinAlways = m_settings.value("/ThinAlways", false).toBool();
+	iDedupWindow = m_settings.value("/DedupWindow", 20).toInt();
+	m_settings.endGroup();
+
+	// JACK specific options...
+	m_settings.beginGroup("/Jack");
+	iJackSpinTime = m_settings.value("/SpinTime", 0).toInt();
+	if (iJackSpinTime < 0)
+		iJackSpinTime = 0;
+	iJackLatency = m_settings.value("/Latency", 0).toInt();
+	iJackRingBufferSize = m_settings.value("/RingBufferSize", 0).toInt();
+	iJackOverload = m_settings.value("/Overload", 0).toInt();
+	bJackPolled = m_settings.value("/NetworkPolled", false).toBool();
+	m_settings.endGroup();
+
+	// ALSA specific options...
+	m_settings.beginGroup("/Alsa");
+	iAlsaPlayoutDelay = m_settings.value("/PlayoutDelay", 0).toInt();
+	iAlsaEventFilter = m_settings.value("/EventFilter", 0).toInt();
+	alsaRawMidiDevices = m_settings.value("/RawMidiDevices").toStringList();
+	bAlsaUmp = m_settings.value("/Ump", false).toBool();
 	m_settings.endGroup();
 
 	m_settings.endGroup();
@@ -105,6 +132,7 @@ void qmidinetOptions::saveOptions (void)
 	m_settings.setValue("/NumPorts", iNumPorts);
 	m_settings.setValue("/AlsaMidi", bAlsaMidi);
 	m_settings.setValue("/JackMidi", bJackMidi);
+	m_settings.setValue("/Backends", backends);
 	m_settings.endGroup();
 
 	// Network specific options...
@@ -112,6 +140,30 @@ void qmidinetOptions::saveOptions (void)
 	m_settings.setValue("/Interface", sInterface);
 	m_settings.setValue("/UdpAddr", sUdpAddr);
 	m_settings.setValue("/UdpPort", iUdpPort);
+	m_settings.setValue("/WireFormat", iWireFormat);
+	m_settings.setValue("/Routes", routes);
+	m_settings.setValue("/Filters", filters);
+	m_settings.setValue("/Priorities", priorities);
+	m_settings.setValue("/ThinRate", iThinRate);
+	m_settings.setValue("/ThinAlways", bThinAlways);
+	m_settings.setValue("/DedupWindow", iDedupWindow);
+	m_settings.endGroup();
+
+	// JACK specific options...
+	m_settings.beginGroup("/Jack");
+	m_settings.setValue("/SpinTime", iJackSpinTime);
+	m_settings.setValue("/Latency", iJackLatency);
+	m_settings.setValue("/RingBufferSize", iJackRingBufferSize);
+	m_settings.setValue("/Overload", iJackOverload);
+	m_settings.setValue("/NetworkPolled", bJackPolled);
+	m_settings.endGroup();
+
+	// ALSA specific options...
+	m_settings.beginGroup("/Alsa");
+	m_settings.setValue("/PlayoutDelay", iAlsaPlayoutDelay);
+	m_settings.setValue("/EventFilter", iAlsaEventFilter);
+	m_settings.setValue("/RawMidiDevices", alsaRawMidiDevices);
+	m_settings.setValue("/Ump", bAlsaUmp);
 	m_settings.endGroup();
 
 	m_settings.endGroup();
@@ -128,12 +180,38 @@ QSettings& qmidinetOptions::settings (void)
 }
 
 
+// Network wire format names (command line).
+static const char *g_wire_format_names[] = { "raw", "timed", "ump", nullptr };
+
+QString qmidinetOptions::wire_format_name ( int iWireFormat )
+{
+	for (int i = 0; g_wire_format_names[i]; ++i) {
+		if (i == iWireFormat)
+			return g_wire_format_names[i];
+	}
+
+	return QString::number(iWireFormat);
+}
+
+int qmidinetOptions::wire_format_value ( const QString& sWireFormat )
+{
+	bool bOK = false;
+	const int iVal = sWireFormat.toInt(&bOK);
+	for (int i = 0; g_wire_format_names[i]; ++i) {
+		if ((bOK && i == iVal) || sWireFormat == g_wire_format_names[i])
+			return i;
+	}
+
+	return -1;
+}
+
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
 
 void qmidinetOptions::show_error( const QString& msg )
 {
-#if defined(Q_OS_WINDOWS)
-	QMessageBox::information(nullptr, QApplication::applicationName(), msg);
+#if defined(Q_OS_WINDOWS) && defined(QT_WIDGETS_LIB)
+	QMessageBox::information(nullptr, QCoreApplication::applicationName(), msg);
 #else
 	const QByteArray tmp = msg.toUtf8() + '\n';
 	::fputs(tmp.constData(), stderr);
@@ -164,12 +242,36 @@ void qmidinetOptions::print_usage ( const QString& arg0 )
 	out << "  -p, --udp-port <port>" + sEot +
 		QObject::tr("Use specific network port (default = %1)")
 			.arg(iUdpPort) + sEol;
+	out << "  -w, --wire-format <format>" + sEot +
+		QObject::tr("Use specific network wire format (raw|timed|ump, default = %1)")
+			.arg(wire_format_name(iWireFormat)) + sEol;
+	out << "  -r, --routes <routes>" + sEot +
+		QObject::tr("Use specific port routing (comma-separated, eg. \"0<>1,1>0\")")
+			+ sEol;
+	out << "  -s, --priorities <priorities>" + sEot +
+		QObject::tr("Merge senders by priority (comma-separated, eg. \"192.168.1.10=4\")")
+			+ sEol;
+	out << "  -t, --thin-rate <hz>" + sEot +
+		QObject::tr("Cap continuous controllers to this rate, while congested (0 = none, default = %1)")
+			.arg(iThinRate) + sEol;
+	out << "  -T, --thin-always <flag>" + sEot +
+		QObject::tr("Cap continuous controllers always, congested or not (0|1|yes|no|on|off, default = %1)")
+			.arg(int(bThinAlways)) + sEol;
+	out << "  -m, --merge-window <msecs>" + sEot +
+		QObject::tr("Drop network echoes, and duplicates merged from several MIDI backends (0 = none, default = %1)")
+			.arg(iDedupWindow) + sEol;
+	out << "  -f, --filters <rules>" + sEot +
+		QObject::tr("Drop matching messages (semicolon-separated, eg. \"types=sensing,clock; dir=in channels=10\")")
+			+ sEol;
 	out << "  -a, --alsa-midi <flag>" + sEot +
 		QObject::tr("Enable ALSA MIDI (0|1|yes|no|on|off, default = %1)")
 			.arg(int(bAlsaMidi)) + sEol;
 	out << "  -j, --jack-midi <flag>" + sEot +
 		QObject::tr("Enable JACK MIDI (0|1|yes|no|on|off, default = %1)")
 			.arg(int(bJackMidi)) + sEol;
+	out << "  -b, --backends <names>" + sEot +
+		QObject::tr("Use additional MIDI backends (comma-separated, eg. null,loopback)")
+			+ sEol;
 	out << "  -g, --no-gui" + sEot +
 		QObject::tr("Disable the graphical user interface (GUI)") + sEol;
 	out << "  -?, --help" + sEot +
@@ -194,8 +296,16 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 	const QString s_interface  = "interface";
 	const QString s_udp_addr   = "udp-addr";
 	const QString s_udp_port   = "udp-port";
+	const QString s_wire_format = "wire-format";
+	const QString s_routes     = "routes";
+	const QString s_filters    = "filters";
+	const QString s_priorities = "priorities";
+	const QString s_thin_rate  = "thin-rate";
+	const QString s_thin_always = "thin-always";
+	const QString s_merge_window = "merge-window";
 	const QString s_alsa_midi  = "alsa-midi";
 	const QString s_jack_midi  = "jack-midi";
+	const QString s_backends   = "backends";
 	const QString s_no_gui     = "no-gui";
 	const QString s_help       = "help";
 
@@ -211,12 +321,36 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 	parser.addOption({{"p", s_udp_port},
 		QObject::tr("Use specific network port (default = %1)")
 			.arg(iUdpPort), "port"});
+	parser.addOption({{"w", s_wire_format},
+		QObject::tr("Use specific network wire format (raw|timed|ump, default = %1)")
+			.arg(wire_format_name(iWireFormat)), "format"});
+	parser.addOption({{"r", s_routes},
+		QObject::tr("Use specific port routing (comma-separated, eg. \"0<>1,1>0\")"),
+			"routes"});
+	parser.addOption({{"s", s_priorities},
+		QObject::tr("Merge senders by priority (comma-separated, eg. \"192.168.1.10=4\")"),
+			"priorities"});
+	parser.addOption({{"t", s_thin_rate},
+		QObject::tr("Cap continuous controllers to this rate, while congested (0 = none, default = %1)")
+			.arg(iThinRate), "hz"});
+	parser.addOption({{"T", s_thin_always},
+		QObject::tr("Cap continuous controllers always, congested or not (0|1|yes|no|on|off, default = %1)")
+			.arg(int(bThinAlways)), "flag"});
+	parser.addOption({{"m", s_merge_window},
+		QObject::tr("Drop network echoes, and duplicates merged from several MIDI backends (0 = none, default = %1)")
+			.arg(iDedupWindow), "msecs"});
+	parser.addOption({{"f", s_filters},
+		QObject::tr("Drop matching messages (semicolon-separated, eg. \"types=sensing,clock; dir=in channels=10\")"),
+			"rules"});
 	parser.addOption({{"a", s_alsa_midi},
 		QObject::tr("Enable ALSA MIDI (0|1|yes|no|on|off, default = %1)")
 			.arg(int(bAlsaMidi)), "flag"});
 	parser.addOption({{"j", s_jack_midi},
 		QObject::tr("Enable JACK MIDI (0|1|yes|no|on|off, default = %1)")
 			.arg(int(bJackMidi)), "flag"});
+	parser.addOption({{"b", s_backends},
+		QObject::tr("Use additional MIDI backends (comma-separated, eg. null,loopback)"),
+			"names"});
 	parser.addOption({{"g", s_no_gui},
 		QObject::tr("Disable the graphical user interface (GUI)")});
 	parser.addOption({{"?", s_help},
@@ -242,10 +376,15 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 		sVersion += "-static";
 	#endif
 	#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
-		sVersion += ' ';
-		sVersion += '(';
-		sVersion += QApplication::platformName();
-		sVersion += ')';
+		// Platform name is a QGuiApplication property (if any)...
+		const QString& sPlatformName
+			= QCoreApplication::instance()->property("platformName").toString();
+		if (!sPlatformName.isEmpty()) {
+			sVersion += ' ';
+			sVersion += '(';
+			sVersion += sPlatformName;
+			sVersion += ')';
+		}
 	#endif
 		sVersion += '\n';
 		show_error(sVersion);
@@ -285,6 +424,15 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 		iUdpPort = iVal;
 	}
 
+	if (parser.isSet(s_wire_format)) {
+		const int iVal = wire_format_value(parser.value(s_wire_format));
+		if (iVal < 0) {
+			show_error(QObject::tr("Option -w requires an argument (format)."));
+			return false;
+		}
+		iWireFormat = iVal;
+	}
+
 	if (parser.isSet(s_alsa_midi)) {
 		const QString& sVal = parser.value(s_alsa_midi);
 		if (sVal.isEmpty()) {
@@ -303,6 +451,59 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 		}
 	}
 
+	if (parser.isSet(s_routes)) {
+		routes = parser.value(s_routes).split(',');
+		routes.removeAll(QString());
+	}
+
+	if (parser.isSet(s_priorities)) {
+		priorities = parser.value(s_priorities).split(',');
+		for (QString& sPriority : priorities)
+			sPriority = sPriority.trimmed();
+		priorities.removeAll(QString());
+	}
+
+	if (parser.isSet(s_thin_rate)) {
+		bool bOK = false;
+		const int iVal = parser.value(s_thin_rate).toInt(&bOK);
+		if (!bOK || iVal < 0) {
+			show_error(QObject::tr("Option -t requires an argument (hz)."));
+			return false;
+		}
+		iThinRate = iVal;
+	}
+
+	if (parser.isSet(s_thin_always)) {
+		const QString& sVal = parser.value(s_thin_always);
+		if (sVal.isEmpty()) {
+			bThinAlways = true;
+		} else {
+			bThinAlways = !(sVal == "0" || sVal == "no" || sVal == "off");
+		}
+	}
+
+	if (parser.isSet(s_merge_window)) {
+		bool bOK = false;
+		const int iVal = parser.value(s_merge_window).toInt(&bOK);
+		if (!bOK || iVal < 0) {
+			show_error(QObject::tr("Option -m requires an argument (msecs)."));
+			return false;
+		}
+		iDedupWindow = iVal;
+	}
+
+	if (parser.isSet(s_filters)) {
+		filters = parser.value(s_filters).split(';');
+		for (QString& sFilter : filters)
+			sFilter = sFilter.trimmed();
+		filters.removeAll(QString());
+	}
+
+	if (parser.isSet(s_backends)) {
+		backends = parser.value(s_backends).split(',');
+		backends.removeAll(QString());
+	}
+
 	if (parser.isSet(s_no_gui)) {
 		// Ignored: parsed on startup...
 	}
@@ -360,6 +561,65 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 			if (iEqual < 0) ++i;
 		}
 		else
+		if (sArg == "-w" || sArg == "--wire-format") {
+			const int iVal = wire_format_value(sVal);
+			if (iVal < 0) {
+				out << QObject::tr("Option -w requires an argument (format).") + sEol;
+				return false;
+			}
+			iWireFormat = iVal;
+			if (iEqual < 0) ++i;
+		}
+		else
+		if (sArg == "-r" || sArg == "--routes") {
+			routes = sVal.split(',');
+			routes.removeAll(QString());
+			if (iEqual < 0) ++i;
+		}
+		else
+		if (sArg == "-s" || sArg == "--priorities") {
+			priorities = sVal.split(',');
+			for (QString& sPriority : priorities)
+				sPriority = sPriority.trimmed();
+			priorities.removeAll(QString());
+			if (iEqual < 0) ++i;
+		}
+		else
+		if (sArg == "-t" || sArg == "--thin-rate") {
+			if (sVal.isEmpty()) {
+				out << QObject::tr("Option -t requires an argument (hz).") + sEol;
+				return false;
+			}
+			iThinRate = sVal.toInt();
+			if (iEqual < 0) ++i;
+		}
+		else
+		if (sArg == "-T" || sArg == "--thin-always") {
+			if (sVal.isEmpty()) {
+				bThinAlways = true;
+			} else {
+				bThinAlways = !(sVal == "0" || sVal == "no" || sVal == "off");
+				if (iEqual < 0) ++i;
+			}
+		}
+		else
+		if (sArg == "-m" || sArg == "--merge-window") {
+			if (sVal.isEmpty()) {
+				out << QObject::tr("Option -m requires an argument (msecs).") + sEol;
+				return false;
+			}
+			iDedupWindow = sVal.toInt();
+			if (iEqual < 0) ++i;
+		}
+		else
+		if (sArg == "-f" || sArg == "--filters") {
+			filters = sVal.split(';');
+			for (QString& sFilter : filters)
+				sFilter = sFilter.trimmed();
+			filters.removeAll(QString());
+			if (iEqual < 0) ++i;
+		}
+		else
 		if (sArg == "-a" || sArg == "--alsa-midi") {
 			if (sVal.isEmpty()) {
 				bAlsaMidi = true;
@@ -378,6 +638,12 @@ bool qmidinetOptions::parse_args ( const QStringList& args )
 			}
 		}
 		else
+		if (sArg == "-b" || sArg == "--backends") {
+			backends = sVal.split(',');
+			backends.removeAll(QString());
+			if (iEqual < 0) ++i;
+		}
+		else
 		if (sArg == "-?" || sArg == "--help") {
 			print_usage(args.at(0));
 			return false;
@@ -61,15 +61,40 @@ public:
 	void print_usage(const QString& arg0);
 #endif
 
+	// Network wire format names helpers.
+	static QString wire_format_name(int iWireFormat);
+	static int wire_format_value(const QString& sWireFormat);
+
 	// General options...
 	int     iNumPorts;
 	bool    bAlsaMidi;
 	bool    bJackMidi;
+	QStringList backends;
 
 	// Network options...
 	QString sInterface;
 	QString sUdpAddr;
 	int     iUdpPort;
+	int     iWireFormat;
+	QStringList routes;
+	QStringList filters;
+	QStringList priorities;
+	int     iThinRate;
+	bool    bThinAlways;
+	int     iDedupWindow;
+
+	// JACK specific options...
+	int     iJackSpinTime;
+	int     iJackLatency;
+	int     iJackRingBufferSize;
+	int     iJackOverload;
+	bool    bJackPolled;
+
+	// ALSA specific options...
+	int     iAlsaPlayoutDelay;
+	int     iAlsaEventFilter;
+	QStringList alsaRawMidiDevices;
+	bool    bAlsaUmp;
 
 	// Singleton instance accessor.
 	static qmidinetOptions *getInstance();
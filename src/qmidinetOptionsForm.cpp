@@ -23,6 +23,7 @@
 #include "qmidinetOptionsForm.h"
 
 #include "qmidinetOptions.h"
+#include "qmidinetRoutes.h"
 
 #include <QMessageBox>
 
@@ -81,6 +82,8 @@ qmidinetOptionsForm::qmidinetOptionsForm ( QWidget *pParent )
 		else
 			m_ui.UdpAddrComboBox->setEditText(pOptions->sUdpAddr);
 		m_ui.UdpPortSpinBox->setValue(pOptions->iUdpPort);
+		m_ui.WireFormatComboBox->setCurrentIndex(pOptions->iWireFormat);
+		m_ui.RoutesLineEdit->setText(pOptions->routes.join(", "));
 		m_ui.NumPortsSpinBox->setValue(pOptions->iNumPorts);
 		m_ui.AlsaMidiCheckBox->setChecked(pOptions->bAlsaMidi);
 		m_ui.JackMidiCheckBox->setChecked(pOptions->bJackMidi);
@@ -109,6 +112,12 @@ qmidinetOptionsForm::qmidinetOptionsForm ( QWidget *pParent )
 	QObject::connect(m_ui.UdpPortSpinBox,
 		SIGNAL(valueChanged(int)),
 		SLOT(change()));
+	QObject::connect(m_ui.WireFormatComboBox,
+		SIGNAL(activated(int)),
+		SLOT(change()));
+	QObject::connect(m_ui.RoutesLineEdit,
+		SIGNAL(textChanged(const QString&)),
+		SLOT(change()));
 	QObject::connect(m_ui.NumPortsSpinBox,
 		SIGNAL(valueChanged(int)),
 		SLOT(change()));
@@ -142,12 +151,29 @@ void qmidinetOptionsForm::accept (void)
 {
 	// Save options...
 	if (m_iDirtyCount > 0) {
+		// Port routing must be sane...
+		QStringList routes = m_ui.RoutesLineEdit->text().split(',');
+		for (QString& sRoute : routes)
+			sRoute = sRoute.trimmed();
+		routes.removeAll(QString());
+		if (!qmidinetRoutes::isValid(routes, m_ui.NumPortsSpinBox->value())) {
+			QMessageBox::warning(this,
+				QDialog::windowTitle(),
+				tr("The port routing is invalid.\n\n"
+				"Each route must be given as N<>M, N>M or N<M, "
+				"from network port N to/from MIDI port M, "
+				"both less than the number of ports."));
+			m_ui.RoutesLineEdit->setFocus();
+			return;
+		}
 		qmidinetOptions *pOptions = qmidinetOptions::getInstance();
 		if (pOptions) {
 			// Display options...
 			pOptions->sInterface = m_ui.InterfaceComboBox->currentText();
 			pOptions->sUdpAddr   = m_ui.UdpAddrComboBox->currentText();
 			pOptions->iUdpPort   = m_ui.UdpPortSpinBox->value();
+			pOptions->iWireFormat = m_ui.WireFormatComboBox->currentIndex();
+			pOptions->routes     = routes;
 			pOptions->iNumPorts  = m_ui.NumPortsSpinBox->value();
 			pOptions->bAlsaMidi  = m_ui.AlsaMidiCheckBox->isChecked();
 			pOptions->bJackMidi  = m_ui.JackMidiCheckBox->isChecked();
@@ -210,6 +236,8 @@ void qmidinetOptionsForm::buttonClick ( QAbstractButton *pButton )
 	#endif
 			m_ui.UdpAddrComboBox->setEditText(QMIDINET_UDP_IPV4_ADDR);
 		m_ui.UdpPortSpinBox->setValue(QMIDINET_UDP_PORT);
+		m_ui.WireFormatComboBox->setCurrentIndex(0);
+		m_ui.RoutesLineEdit->clear();
 	}
 }
 
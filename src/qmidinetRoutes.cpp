@@ -0,0 +1,139 @@
+// qmidinetRoutes.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetRoutes.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetRoutes -- Port routing matrix (network <-> MIDI).
+
+// Constructor.
+qmidinetRoutes::qmidinetRoutes (void)
+{
+	reset(1);
+}
+
+
+// Default (one-to-one) routing.
+void qmidinetRoutes::reset ( int iNumPorts )
+{
+	for (int i = 0; i < MaxPorts; ++i) {
+		const unsigned int mask = (i < iNumPorts ? (1U << i) : 0);
+		m_recv[i] = mask;
+		m_send[i] = mask;
+	}
+}
+
+
+// Compile textual routes.
+bool qmidinetRoutes::compile ( const QStringList& routes, int iNumPorts )
+{
+	reset(iNumPorts);
+
+	if (routes.isEmpty())
+		return true;
+
+	if (!isValid(routes, iNumPorts))
+		return false;
+
+	unsigned int recv[MaxPorts];
+	unsigned int send[MaxPorts];
+	for (int i = 0; i < MaxPorts; ++i)
+		recv[i] = send[i] = 0;
+
+	for (const QString& sRoute : routes) {
+		int iNetPort = 0;
+		int iMidiPort = 0;
+		Direction direction = None;
+		if (!parse(sRoute, &iNetPort, &iMidiPort, &direction))
+			continue;
+		if (direction & Receive)
+			recv[iNetPort] |= (1U << iMidiPort);
+		if (direction & Send)
+			send[iMidiPort] |= (1U << iNetPort);
+	}
+
+	for (int i = 0; i < MaxPorts; ++i) {
+		m_recv[i] = recv[i];
+		m_send[i] = send[i];
+	}
+
+	return true;
+}
+
+
+// Textual route parser.
+bool qmidinetRoutes::parse ( const QString& sRoute,
+	int *piNetPort, int *piMidiPort, Direction *pDirection )
+{
+	const QString& sText = sRoute.simplified().remove(' ');
+
+	QString sOp = "<>";
+	Direction direction = Duplex;
+	int iOp = sText.indexOf(sOp);
+	if (iOp < 0) {
+		sOp = ">";
+		direction = Receive;
+		iOp = sText.indexOf(sOp);
+	}
+	if (iOp < 0) {
+		sOp = "<";
+		direction = Send;
+		iOp = sText.indexOf(sOp);
+	}
+	if (iOp < 0)
+		return false;
+
+	bool bNetPort = false;
+	bool bMidiPort = false;
+	const int iNetPort = sText.left(iOp).toInt(&bNetPort);
+	const int iMidiPort = sText.mid(iOp + sOp.length()).toInt(&bMidiPort);
+	if (!bNetPort || iNetPort < 0 || iNetPort >= MaxPorts)
+		return false;
+	if (!bMidiPort || iMidiPort < 0 || iMidiPort >= MaxPorts)
+		return false;
+
+	*piNetPort = iNetPort;
+	*piMidiPort = iMidiPort;
+	*pDirection = direction;
+
+	return true;
+}
+
+
+// Textual routes validator.
+bool qmidinetRoutes::isValid ( const QStringList& routes, int iNumPorts )
+{
+	for (const QString& sRoute : routes) {
+		int iNetPort = 0;
+		int iMidiPort = 0;
+		Direction direction = None;
+		if (!parse(sRoute, &iNetPort, &iMidiPort, &direction))
+			return false;
+		if (iNetPort >= iNumPorts || iMidiPort >= iNumPorts)
+			return false;
+	}
+
+	return true;
+}
+
+
+// end of qmidinetRoutes.cpp
@@ -0,0 +1,84 @@
+// qmidinetRoutes.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetRoutes_h
+#define __qmidinetRoutes_h
+
+#include <QStringList>
+
+
+//----------------------------------------------------------------------------
+// qmidinetRoutes -- Port routing matrix (network <-> MIDI).
+//
+// Routes are given as text, one per entry: "N<>M" for both directions,
+// "N>M" for network port N into MIDI port M only, or "N<M" for MIDI
+// port M out to network port N only (port numbers start from zero).
+// An empty list means the default, one-to-one routing (N<>N).
+//
+// They get compiled into a flat table of port bitmasks, one per port
+// and direction, as looked up on the hot path.
+
+class qmidinetRoutes
+{
+public:
+
+	// Maximum number of ports (as in bitmask bits).
+	static const int MaxPorts = 32;
+
+	// Route directions.
+	enum Direction { None = 0, Receive = 1, Send = 2, Duplex = 3 };
+
+	// Constructor.
+	qmidinetRoutes();
+
+	// Default (one-to-one) routing.
+	void reset(int iNumPorts);
+
+	// Compile textual routes (false if any is malformed or out of range;
+	// the default routing is then left in place).
+	bool compile(const QStringList& routes, int iNumPorts);
+
+	// MIDI ports that receive from a network port (bitmask).
+	unsigned int networkToMidi(int port) const
+		{ return (port >= 0 && port < MaxPorts ? m_recv[port] : 0); }
+
+	// Network ports that a MIDI port sends to (bitmask).
+	unsigned int midiToNetwork(int port) const
+		{ return (port >= 0 && port < MaxPorts ? m_send[port] : 0); }
+
+	// Textual route parser (false if malformed).
+	static bool parse(const QString& sRoute,
+		int *piNetPort, int *piMidiPort, Direction *pDirection);
+
+	// Textual routes validator.
+	static bool isValid(const QStringList& routes, int iNumPorts = MaxPorts);
+
+private:
+
+	// Instance variables (compiled table).
+	unsigned int m_recv[MaxPorts];
+	unsigned int m_send[MaxPorts];
+};
+
+
+#endif	// __qmidinetRoutes_h
+
+// end of qmidinetRoutes.h
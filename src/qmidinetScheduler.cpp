@@ -0,0 +1,401 @@
+// qmidinetScheduler.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetScheduler.h"
+
+#if defined(CONFIG_IPV6)
+#include <QHostAddress>
+#endif
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetScheduler -- Fair multi-source merge scheduler (per port).
+
+// IPv4 to IPv4-mapped IPv6 address (::ffff:a.b.c.d).
+static void qmidinetScheduler_addr (
+	const unsigned char *addr, unsigned short naddr, unsigned char *addr16 )
+{
+	::memset(addr16, 0, 16);
+
+	if (naddr == 16) {
+		::memcpy(addr16, addr, 16);
+	}
+	else
+	if (naddr == 4) {
+		addr16[10] = 0xff;
+		addr16[11] = 0xff;
+		::memcpy(&addr16[12], addr, 4);
+	}
+}
+
+
+// Constructor.
+qmidinetScheduler::qmidinetScheduler (void)
+	: m_nports(0), m_pPorts(nullptr)
+{
+	m_timer.start();
+}
+
+
+// Destructor.
+qmidinetScheduler::~qmidinetScheduler (void)
+{
+	clear();
+}
+
+
+// Source priorities accessors (textual).
+void qmidinetScheduler::setPriorities ( const QStringList& priorities )
+{
+	m_priorities = priorities;
+	m_prios.clear();
+
+	for (const QString& sPriority : priorities) {
+		Priority prio;
+		if (parse(sPriority, prio.addr, &prio.priority))
+			m_prios.append(prio);
+	}
+}
+
+const QStringList& qmidinetScheduler::priorities (void) const
+{
+	return m_priorities;
+}
+
+
+// Source queues (re)initializer.
+void qmidinetScheduler::setup ( int iNumPorts )
+{
+	clear();
+
+	if (iNumPorts < 1)
+		return;
+
+	m_nports = iNumPorts;
+	m_pPorts = new Port [m_nports];
+
+	for (int i = 0; i < m_nports; ++i) {
+		Port& p = m_pPorts[i];
+		for (int k = 0; k < MaxSources; ++k) {
+			Source& s = p.sources[k];
+			s.used  = false;
+			s.sysex = false;
+			s.priority = 1;
+			s.count = 0;
+		}
+		p.current = 0;
+		p.credit  = 0;
+		p.owner   = -1;
+	}
+}
+
+
+// Source queues terminator.
+void qmidinetScheduler::clear (void)
+{
+	if (m_pPorts) {
+		delete [] m_pPorts;
+		m_pPorts = nullptr;
+	}
+
+	m_nports = 0;
+}
+
+
+// Queue a datagram from a source address and port.
+bool qmidinetScheduler::enqueue ( int port,
+	const unsigned char *addr, unsigned short naddr, unsigned short sport,
+	const unsigned char *data, unsigned short len )
+{
+	if (port < 0 || port >= m_nports)
+		return false;
+	if (len < 1 || len > qmidinetUdpPacket::MaxSize)
+		return false;
+
+	unsigned char addr16[16];
+	qmidinetScheduler_addr(addr, naddr, addr16);
+
+	const unsigned int t = now();
+
+	// Find the source, or else a free
+	// (or the least recently idle) one...
+	Port& p = m_pPorts[port];
+	int iSource = -1;
+	int iFree = -1;
+	for (int k = 0; k < MaxSources; ++k) {
+		const Source& s = p.sources[k];
+		if (s.used) {
+			if (s.sport == sport && ::memcmp(s.addr, addr16, 16) == 0) {
+				iSource = k;
+				break;
+			}
+			if (s.count > 0 || k == p.owner)
+				continue;
+			if (iFree < 0 || (p.sources[iFree].used
+				&& int(t - s.time) > int(t - p.sources[iFree].time)))
+				iFree = k;
+		}
+		else
+		if (iFree < 0 || p.sources[iFree].used)
+			iFree = k;
+	}
+
+	if (iSource < 0) {
+		// No room for yet another source?
+		if (iFree < 0)
+			return false;
+		iSource = iFree;
+		Source& s = p.sources[iSource];
+		::memcpy(s.addr, addr16, 16);
+		s.sport = sport;
+		s.used  = true;
+		s.sysex = false;
+		s.priority = priority(addr16);
+		s.head  = 0;
+		s.count = 0;
+	}
+
+	Source& s = p.sources[iSource];
+	s.time = t;
+
+	// Too chatty?
+	if (s.count >= QueueSize)
+		return false;
+
+	Datagram& dgram = s.queue[(s.head + s.count) % QueueSize];
+	::memcpy(dgram.data, data, len);
+	dgram.len = len;
+	++s.count;
+
+	return true;
+}
+
+
+// Next datagram, in fair order.
+bool qmidinetScheduler::dequeue ( int port,
+	unsigned char *data, unsigned short *len,
+	unsigned char *addr, unsigned short *sport )
+{
+	if (port < 0 || port >= m_nports)
+		return false;
+
+	Port& p = m_pPorts[port];
+
+	// An open SysEx keeps its source on turn,
+	// unless it stalls for too long...
+	if (p.owner >= 0) {
+		Source& s = p.sources[p.owner];
+		if (s.count < 1) {
+			if (int(now() - s.time) < HoldTime)
+				return false;
+			s.sysex = false;
+			p.owner = -1;
+		} else {
+			p.current = p.owner;
+			if (p.credit < 1)
+				p.credit = 1;
+		}
+	}
+
+	// Weighted round-robin...
+	for (int n = 0; n <= MaxSources; ++n) {
+		Source& s = p.sources[p.current];
+		if (p.credit > 0 && s.used && s.count > 0) {
+			const Datagram& dgram = s.queue[s.head];
+			::memcpy(data, dgram.data, dgram.len);
+			*len = dgram.len;
+			if (addr)
+				::memcpy(addr, s.addr, 16);
+			if (sport)
+				*sport = s.sport;
+			s.head = (s.head + 1) % QueueSize;
+			--s.count;
+			--p.credit;
+			s.sysex = isSysexOpen(data, *len, s.sysex);
+			p.owner = (s.sysex ? p.current : -1);
+			return true;
+		}
+		// Next source on turn...
+		p.current = (p.current + 1) % MaxSources;
+		p.credit = p.sources[p.current].priority;
+	}
+
+	return false;
+}
+
+
+// Whether a port has any source queue full.
+bool qmidinetScheduler::isFull ( int port ) const
+{
+	if (port < 0 || port >= m_nports)
+		return false;
+
+	const Port& p = m_pPorts[port];
+	for (int k = 0; k < MaxSources; ++k) {
+		const Source& s = p.sources[k];
+		if (s.used && s.count >= QueueSize)
+			return true;
+	}
+
+	return false;
+}
+
+
+// Whether a port is holding on an open SysEx, still to be resumed.
+bool qmidinetScheduler::isHolding ( int port ) const
+{
+	if (port < 0 || port >= m_nports)
+		return false;
+
+	const Port& p = m_pPorts[port];
+	return (p.owner >= 0 && p.sources[p.owner].count < 1);
+}
+
+
+// Whether any port is holding.
+bool qmidinetScheduler::isHolding (void) const
+{
+	for (int i = 0; i < m_nports; ++i) {
+		if (isHolding(i))
+			return true;
+	}
+
+	return false;
+}
+
+
+// Whether a SysEx is left open, at the end of a datagram.
+bool qmidinetScheduler::isSysexOpen (
+	const unsigned char *data, unsigned short len, bool bOpen )
+{
+	if (qmidinetUdpPacket::format(data, len) == qmidinetUdpPacket::Raw) {
+		// Raw MIDI bytes (SysEx may span datagrams)...
+		for (unsigned short i = 0; i < len; ++i) {
+			const unsigned char c = data[i];
+			if (c == 0xf0)
+				bOpen = true;
+			else
+			if (c >= 0x80 && c < 0xf8)
+				bOpen = false;
+		}
+		return bOpen;
+	}
+
+	// Time-stamped or UMP events (SysEx may come in chunks)...
+	qmidinetUdpPacketReader packet(data, len);
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short n = 0;
+	while (packet.read(&delta, &pchData, &n)) {
+		const unsigned char status = pchData[0];
+		if (status == 0xf0)
+			bOpen = true;
+		else
+		if (status >= 0x80 && status < 0xf8)
+			bOpen = false;
+		if (pchData[n - 1] == 0xf7)
+			bOpen = false;
+	}
+
+	return bOpen;
+}
+
+
+// Source priority, from its (normalized) address.
+int qmidinetScheduler::priority ( const unsigned char *addr ) const
+{
+	for (const Priority& prio : m_prios) {
+		if (::memcmp(prio.addr, addr, 16) == 0)
+			return prio.priority;
+	}
+
+	return 1;
+}
+
+
+// Textual priority parser.
+bool qmidinetScheduler::parse ( const QString& sPriority,
+	unsigned char *addr, int *piPriority )
+{
+	const int iEqual = sPriority.lastIndexOf('=');
+	if (iEqual < 1)
+		return false;
+
+	bool bOK = false;
+	const int iPriority = sPriority.mid(iEqual + 1).trimmed().toInt(&bOK);
+	if (!bOK || iPriority < 1 || iPriority > MaxPriority)
+		return false;
+
+	const QString& sAddr = sPriority.left(iEqual).trimmed();
+
+#if defined(CONFIG_IPV6)
+	QHostAddress haddr;
+	if (!haddr.setAddress(sAddr))
+		return false;
+	bool bIPv4 = false;
+	const quint32 ipv4 = haddr.toIPv4Address(&bIPv4);
+	if (bIPv4) {
+		const unsigned char addr4[4] = {
+			(unsigned char) ((ipv4 >> 24) & 0xff),
+			(unsigned char) ((ipv4 >> 16) & 0xff),
+			(unsigned char) ((ipv4 >> 8) & 0xff),
+			(unsigned char) (ipv4 & 0xff) };
+		qmidinetScheduler_addr(addr4, 4, addr);
+	} else {
+		const Q_IPV6ADDR& addr6 = haddr.toIPv6Address();
+		qmidinetScheduler_addr(addr6.c, 16, addr);
+	}
+#else
+	const QStringList& octets = sAddr.split('.');
+	if (octets.count() != 4)
+		return false;
+	unsigned char addr4[4];
+	for (int i = 0; i < 4; ++i) {
+		const int iOctet = octets.at(i).toInt(&bOK);
+		if (!bOK || iOctet < 0 || iOctet > 255)
+			return false;
+		addr4[i] = (unsigned char) iOctet;
+	}
+	qmidinetScheduler_addr(addr4, 4, addr);
+#endif
+
+	*piPriority = iPriority;
+	return true;
+}
+
+
+// Textual priorities validator.
+bool qmidinetScheduler::isValid ( const QStringList& priorities )
+{
+	for (const QString& sPriority : priorities) {
+		unsigned char addr[16];
+		int iPriority = 0;
+		if (!parse(sPriority, addr, &iPriority))
+			return false;
+	}
+
+	return true;
+}
+
+
+// end of qmidinetScheduler.cpp
@@ -0,0 +1,171 @@
+// qmidinetScheduler.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetScheduler_h
+#define __qmidinetScheduler_h
+
+#include "qmidinetAbout.h"
+#include "qmidinetUdpPacket.h"
+
+#include <QStringList>
+#include <QElapsedTimer>
+
+
+//----------------------------------------------------------------------------
+// qmidinetScheduler -- Fair multi-source merge scheduler (per port).
+//
+// Received datagrams are queued per sender (source address and port),
+// in a small fixed queue each, then taken out in weighted round-robin
+// order: each source gets as many datagrams per turn as its priority.
+// Whole datagrams go through, never split; besides, a source with an
+// open SysEx keeps its turn until the SysEx is over (or it stalls for
+// longer than the hold time), so that nothing gets spliced into it.
+// Excess datagrams from a chatty source are dropped, not the others'.
+//
+// Priorities are given as text, one per entry: "ADDR=N", where ADDR is
+// a sender address (IPv4 or IPv6) and N its priority (1 to MaxPriority;
+// default is 1, for any other source).
+//
+// Not thread-safe: each port is to be fed and drained by the same thread.
+
+class qmidinetScheduler
+{
+public:
+
+	// Sources and queued datagrams per source (per port).
+	static const int MaxSources = 8;
+	static const int QueueSize  = 4;
+
+	// Maximum source priority.
+	static const int MaxPriority = 16;
+
+	// Open SysEx hold time (msecs).
+	static const int HoldTime = 50;
+
+	// Constructor.
+	qmidinetScheduler();
+
+	// Destructor.
+	~qmidinetScheduler();
+
+	// Source priorities accessors (textual).
+	void setPriorities(const QStringList& priorities);
+	const QStringList& priorities() const;
+
+	// Source queues (re)initializer.
+	void setup(int iNumPorts);
+
+	// Source queues terminator.
+	void clear();
+
+	// Queue a datagram from a source address (4 bytes for IPv4, 16 for
+	// IPv6; network byte order) and port; false if dropped (queue full).
+	bool enqueue(int port, const unsigned char *addr, unsigned short naddr,
+		unsigned short sport, const unsigned char *data, unsigned short len);
+
+	// Next datagram, in fair order (data at least MaxSize long), and
+	// optionally its source address (16 bytes, as IPv6) and port;
+	// false if there's none (or an open SysEx is being held).
+	bool dequeue(int port, unsigned char *data, unsigned short *len,
+		unsigned char *addr = nullptr, unsigned short *sport = nullptr);
+
+	// Whether a port has any source queue full.
+	bool isFull(int port) const;
+
+	// Whether a port is holding on an open SysEx, still to be resumed.
+	bool isHolding(int port) const;
+
+	// Whether any port is holding.
+	bool isHolding() const;
+
+	// Textual priority parser (false if malformed).
+	static bool parse(const QString& sPriority,
+		unsigned char *addr, int *piPriority);
+
+	// Textual priorities validator.
+	static bool isValid(const QStringList& priorities);
+
+protected:
+
+	// Whether a SysEx is left open, at the end of a datagram.
+	static bool isSysexOpen(const unsigned char *data,
+		unsigned short len, bool bOpen);
+
+	// Source priority, from its (normalized) address.
+	int priority(const unsigned char *addr) const;
+
+	// Current time (msecs; wrapping).
+	unsigned int now() const
+		{ return (unsigned int) m_timer.elapsed(); }
+
+private:
+
+	// Queued datagram.
+	struct Datagram
+	{
+		unsigned short len;
+		unsigned char  data[qmidinetUdpPacket::MaxSize];
+	};
+
+	// Source queue.
+	struct Source
+	{
+		unsigned char  addr[16];  // IPv6 (or IPv4-mapped) address.
+		unsigned short sport;
+		bool           used;
+		bool           sysex;     // open SysEx (last datagram).
+		int            priority;
+		unsigned int   time;      // last queued (msecs).
+		unsigned short head;
+		unsigned short count;
+		Datagram       queue[QueueSize];
+	};
+
+	// Port merge state.
+	struct Port
+	{
+		Source sources[MaxSources];
+		int    current;   // source on turn...
+		int    credit;    // ...and its datagrams left.
+		int    owner;     // source holding an open SysEx (-1 if none).
+	};
+
+	// Compiled source priority.
+	struct Priority
+	{
+		unsigned char addr[16];
+		int           priority;
+	};
+
+	// Instance variables.
+	int   m_nports;
+	Port *m_pPorts;
+
+	QStringList     m_priorities;
+	QList<Priority> m_prios;
+
+	QElapsedTimer m_timer;
+};
+
+
+#endif	// __qmidinetScheduler_h
+
+// end of qmidinetScheduler.h
@@ -0,0 +1,327 @@
+// qmidinetSenders.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetSenders.h"
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetSenders -- Per-sender stream state table (reassembly).
+
+// MIDI message size, from its status byte (SysEx excepted).
+static unsigned short qmidinetSenders_status_size ( unsigned char status )
+{
+	switch (status & 0xf0) {
+	case 0xc0:
+	case 0xd0:
+		return 2;
+	case 0xf0:
+		switch (status) {
+		case 0xf1:
+		case 0xf3:
+			return 2;
+		case 0xf2:
+			return 3;
+		default:
+			return 1;
+		}
+	default:
+		return 3;
+	}
+}
+
+
+// Append a complete message (or chunk), if there's room.
+static unsigned short qmidinetSenders_append ( unsigned char *data,
+	unsigned short n, const unsigned char *msg, unsigned short len )
+{
+	if (n + len > qmidinetSenders::MaxSize)
+		return n;
+
+	::memcpy(data + n, msg, len);
+	return n + len;
+}
+
+
+// Sender entry (stream state).
+struct qmidinetSenders::Entry
+{
+	unsigned int   hash;
+	unsigned int   time;      // last seen (msecs).
+	unsigned char  addr[16];  // IPv6 (or IPv4-mapped) address.
+	unsigned short sport;
+	int            port;      // network port (-1 if free).
+
+	// Time-stamped datagrams sequence tracking.
+	bool           seqok;
+	unsigned short seqno;     // newest seen...
+	quint64        seqmask;   // ...and the ones before (bitmap).
+
+	// Raw MIDI running status (0xf0 while within SysEx).
+	unsigned char  status;
+	unsigned char  msg[3];    // partial message...
+	unsigned char  nmsg;      // ...and its length.
+
+	// Raw MIDI SysEx reassembly.
+	unsigned short nsysex;
+	unsigned char  sysex[SysexSize + 1];
+};
+
+
+// Constructor.
+qmidinetSenders::qmidinetSenders (void)
+	: m_pTable(nullptr), m_ncount(0), m_nlost(0), m_nduplicates(0)
+{
+}
+
+
+// Destructor.
+qmidinetSenders::~qmidinetSenders (void)
+{
+	clear();
+}
+
+
+// State table (re)initializer.
+void qmidinetSenders::setup (void)
+{
+	clear();
+
+	m_pTable = new Entry [TableSize];
+	for (int i = 0; i < TableSize; ++i)
+		m_pTable[i].port = -1;
+
+	m_timer.start();
+}
+
+
+// State table terminator.
+void qmidinetSenders::clear (void)
+{
+	if (m_pTable) {
+		delete [] m_pTable;
+		m_pTable = nullptr;
+	}
+
+	m_ncount = 0;
+	m_nlost = 0;
+	m_nduplicates = 0;
+}
+
+
+// Sender key hash (FNV-1a).
+unsigned int qmidinetSenders::hash ( int port,
+	const unsigned char *addr, unsigned short sport )
+{
+	unsigned int h = 2166136261U;
+
+	for (int i = 0; i < 16; ++i) {
+		h ^= addr[i];
+		h *= 16777619U;
+	}
+
+	h ^= (sport >> 8);
+	h *= 16777619U;
+	h ^= (sport & 0xff);
+	h *= 16777619U;
+	h ^= (port & 0xff);
+	h *= 16777619U;
+
+	return h;
+}
+
+
+// Find a sender entry (or else a new one, evicting as needed).
+qmidinetSenders::Entry *qmidinetSenders::lookup ( int port,
+	const unsigned char *addr, unsigned short sport )
+{
+	const unsigned int h = hash(port, addr, sport);
+	const unsigned int t = now();
+
+	Entry *pVictim = nullptr;
+	int iVictimAge = -1;
+
+	for (int k = 0; k < ProbeSize; ++k) {
+		Entry *pEntry = &m_pTable[(h + k) & (TableSize - 1)];
+		const int iAge = (pEntry->port < 0 ? 0x7fffffff : int(t - pEntry->time));
+		if (iAge <= StaleTime && pEntry->hash == h
+			&& pEntry->port == port && pEntry->sport == sport
+			&& ::memcmp(pEntry->addr, addr, 16) == 0)
+			return pEntry;
+		// Free, stale or else the least recently seen...
+		if (iAge > iVictimAge) {
+			pVictim = pEntry;
+			iVictimAge = iAge;
+		}
+	}
+
+	if (pVictim->port < 0)
+		++m_ncount;
+
+	pVictim->hash  = h;
+	pVictim->time  = t;
+	::memcpy(pVictim->addr, addr, 16);
+	pVictim->sport = sport;
+	pVictim->port  = port;
+	pVictim->seqok = false;
+	pVictim->seqno = 0;
+	pVictim->seqmask = 0;
+	pVictim->status = 0;
+	pVictim->nmsg  = 0;
+	pVictim->nsysex = 0;
+
+	return pVictim;
+}
+
+
+// Process a datagram from a sender.
+unsigned short qmidinetSenders::process ( int port,
+	const unsigned char *addr, unsigned short sport,
+	const unsigned char *in, unsigned short len, unsigned char *data )
+{
+	if (len > MaxSize)
+		len = MaxSize;
+
+	if (m_pTable == nullptr || port < 0) {
+		::memcpy(data, in, len);
+		return len;
+	}
+
+	Entry *pEntry = lookup(port, addr, sport);
+	pEntry->time = now();
+
+	const qmidinetUdpPacket::Format format
+		= qmidinetUdpPacket::format(in, len);
+	if (format == qmidinetUdpPacket::Raw)
+		return processRaw(pEntry, in, len, data);
+
+	if (format == qmidinetUdpPacket::Timed) {
+		// Sequence tracking: late ones go through,
+		// unless already seen (duplicates)...
+		const unsigned short seqno = qmidinetUdpPacketReader(in, len).seqno();
+		const int delta = short(seqno - pEntry->seqno);
+		if (!pEntry->seqok || delta <= -SeqnoWindow) {
+			// New (or restarted) sender...
+			pEntry->seqok = true;
+			pEntry->seqno = seqno;
+			pEntry->seqmask = 1;
+		}
+		else
+		if (delta > 0) {
+			m_nlost += delta - 1;
+			pEntry->seqmask = (delta < SeqnoWindow
+				? (pEntry->seqmask << delta) | 1 : 1);
+			pEntry->seqno = seqno;
+		} else {
+			const quint64 bit = (quint64(1) << -delta);
+			if (pEntry->seqmask & bit) {
+				++m_nduplicates;
+				return 0;
+			}
+			pEntry->seqmask |= bit;
+			if (m_nlost > 0)
+				--m_nlost;
+		}
+	}
+
+	::memcpy(data, in, len);
+	return len;
+}
+
+
+// Raw MIDI datagram reassembly.
+unsigned short qmidinetSenders::processRaw ( Entry *pEntry,
+	const unsigned char *in, unsigned short len, unsigned char *data )
+{
+	unsigned short n = 0;
+
+	for (unsigned short i = 0; i < len; ++i) {
+		const unsigned char c = in[i];
+		// Real-time messages go through, anywhere...
+		if (c >= 0xf8) {
+			n = qmidinetSenders_append(data, n, &c, 1);
+			continue;
+		}
+		// Within SysEx, up to its end...
+		if (pEntry->status == 0xf0) {
+			if (c < 0x80) {
+				if (pEntry->nsysex >= SysexSize) {
+					// Too long, pass it on in chunks: what follows
+					// is a continuation (no leading 0xf0), as taken by
+					// qmidinetUdpPacketReader (only real-time messages
+					// may go in between, as they leave it alone)...
+					n = qmidinetSenders_append(data, n,
+						pEntry->sysex, pEntry->nsysex);
+					pEntry->nsysex = 0;
+				}
+				pEntry->sysex[pEntry->nsysex++] = c;
+				continue;
+			}
+			if (c == 0xf7) {
+				pEntry->sysex[pEntry->nsysex++] = c;
+				n = qmidinetSenders_append(data, n,
+					pEntry->sysex, pEntry->nsysex);
+				pEntry->nsysex = 0;
+				pEntry->status = 0;
+				continue;
+			}
+			// Aborted by any other status...
+			pEntry->nsysex = 0;
+			pEntry->status = 0;
+		}
+		if (c == 0xf0) {
+			// SysEx begins...
+			pEntry->sysex[0] = c;
+			pEntry->nsysex = 1;
+			pEntry->status = c;
+			pEntry->nmsg = 0;
+			continue;
+		}
+		if (c == 0xf7)
+			continue; // Stray end of SysEx, skip it.
+		if (c >= 0x80) {
+			// New status (running, unless system common)...
+			pEntry->msg[0] = c;
+			pEntry->nmsg = 1;
+			pEntry->status = (c < 0xf0 ? c : 0);
+		} else {
+			// Data bytes, on running status...
+			if (pEntry->nmsg < 1) {
+				if (pEntry->status < 0x80)
+					continue; // Stray data byte, skip it.
+				pEntry->msg[0] = pEntry->status;
+				pEntry->nmsg = 1;
+			}
+			pEntry->msg[pEntry->nmsg++] = c;
+		}
+		// Complete message?
+		if (pEntry->nmsg >= qmidinetSenders_status_size(pEntry->msg[0])) {
+			n = qmidinetSenders_append(data, n, pEntry->msg, pEntry->nmsg);
+			pEntry->nmsg = 0;
+		}
+	}
+
+	return n;
+}
+
+
+// end of qmidinetSenders.cpp
@@ -0,0 +1,126 @@
+// qmidinetSenders.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetSenders_h
+#define __qmidinetSenders_h
+
+#include "qmidinetUdpPacket.h"
+
+#include <QElapsedTimer>
+
+
+//----------------------------------------------------------------------------
+// qmidinetSenders -- Per-sender stream state table (reassembly).
+//
+// Each sender (source address and port, per network port) gets its own
+// stream state, kept in a small open-addressed hash table: raw MIDI
+// running status, partial messages and SysEx are carried across its
+// datagrams only, and reassembled into complete, self-contained ones;
+// time-stamped datagram sequence numbers are tracked, so that lost ones
+// get counted and duplicate (or late) ones dropped. Stale senders are
+// forgotten, and the least recently seen evicted when out of room.
+//
+// Not thread-safe: each port is to be processed by the same thread.
+
+class qmidinetSenders
+{
+public:
+
+	// Maximum processed datagram size: a reassembled SysEx (up to
+	// SysexSize) plus a whole datagram with running status restored.
+	static const unsigned short MaxSize = 3 * qmidinetUdpPacket::MaxSize;
+
+	// Constructor.
+	qmidinetSenders();
+
+	// Destructor.
+	~qmidinetSenders();
+
+	// State table (re)initializer.
+	void setup();
+
+	// State table terminator.
+	void clear();
+
+	// Process a datagram from a sender (address as IPv6, or IPv4-mapped)
+	// into data (at least MaxSize long); returns the number of bytes to
+	// dispatch (0 if none: dropped or still incomplete).
+	unsigned short process(int port,
+		const unsigned char *addr, unsigned short sport,
+		const unsigned char *in, unsigned short len, unsigned char *data);
+
+	// Statistics accessors (may be a little off).
+	int count() const { return m_ncount; }
+	unsigned long lost() const { return m_nlost; }
+	unsigned long duplicates() const { return m_nduplicates; }
+
+protected:
+
+	// Sender entry (stream state).
+	struct Entry;
+
+	// Sender key hash (FNV-1a).
+	static unsigned int hash(int port,
+		const unsigned char *addr, unsigned short sport);
+
+	// Find a sender entry (or else a new one, evicting as needed).
+	Entry *lookup(int port,
+		const unsigned char *addr, unsigned short sport);
+
+	// Raw MIDI datagram reassembly.
+	unsigned short processRaw(Entry *pEntry,
+		const unsigned char *in, unsigned short len, unsigned char *data);
+
+	// Current time (msecs; wrapping).
+	unsigned int now() const
+		{ return (unsigned int) m_timer.elapsed(); }
+
+private:
+
+	// Hash table size (a power of two) and probe length.
+	static const int TableSize = 256;
+	static const int ProbeSize = 8;
+
+	// Reassembled SysEx size, per sender (longer ones are passed on
+	// in chunks, the first one with the leading 0xf0, the others as
+	// continuations, all with no other message in between).
+	static const unsigned short SysexSize = qmidinetUdpPacket::MaxSize;
+
+	// Stale sender time (msecs).
+	static const int StaleTime = 30000;
+
+	// Late (or duplicate) time-stamped datagrams window (bits).
+	static const int SeqnoWindow = 64;
+
+	// Instance variables.
+	Entry        *m_pTable;
+
+	int           m_ncount;
+	unsigned long m_nlost;
+	unsigned long m_nduplicates;
+
+	QElapsedTimer m_timer;
+};
+
+
+#endif	// __qmidinetSenders_h
+
+// end of qmidinetSenders.h
@@ -0,0 +1,239 @@
+// qmidinetThinner.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetThinner.h"
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetThinner -- Continuous controller thinning (rate capped).
+
+// Constructor.
+qmidinetThinner::qmidinetThinner (void)
+	: m_nports(0), m_period(0), m_bAlways(false),
+		m_bCongested(false), m_congested(0),
+		m_pSlots(nullptr), m_pPending(nullptr)
+{
+}
+
+
+// Destructor.
+qmidinetThinner::~qmidinetThinner (void)
+{
+	clear();
+}
+
+
+// Slot table (re)initializer.
+void qmidinetThinner::setup ( int iNumPorts, int iRate, bool bAlways )
+{
+	clear();
+
+	if (iNumPorts < 1 || iRate < 1)
+		return;
+
+	QMutexLocker locker(&m_mutex);
+
+	m_nports = iNumPorts;
+	m_period = 1000000 / iRate;
+
+	m_bAlways = bAlways;
+	m_bCongested = false;
+
+	const int nslots = m_nports * 16 * NumSlots;
+	m_pSlots = new Slot [nslots];
+	::memset(m_pSlots, 0, nslots * sizeof(Slot));
+
+	m_pPending = new int [m_nports];
+	for (int i = 0; i < m_nports; ++i)
+		m_pPending[i] = 0;
+
+	m_timer.start();
+
+	// Let the very first ones through...
+	const unsigned int t0 = now() - m_period;
+	for (int i = 0; i < nslots; ++i)
+		m_pSlots[i].time = t0;
+}
+
+
+// Slot table terminator.
+void qmidinetThinner::clear (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_pPending) {
+		delete [] m_pPending;
+		m_pPending = nullptr;
+	}
+
+	if (m_pSlots) {
+		delete [] m_pSlots;
+		m_pSlots = nullptr;
+	}
+
+	m_nports = 0;
+	m_period = 0;
+
+	m_bAlways = false;
+	m_bCongested = false;
+}
+
+
+// Congestion signal.
+void qmidinetThinner::congest (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_pSlots == nullptr)
+		return;
+
+	m_bCongested = true;
+	m_congested = now();
+}
+
+
+// Whether the rate cap applies now (locked).
+bool qmidinetThinner::isCongested ( unsigned int t )
+{
+	if (m_bCongested && t - m_congested >= 1000 * CongestTime)
+		m_bCongested = false;
+
+	return (m_bAlways || m_bCongested);
+}
+
+
+// Slot index from a MIDI message (-1 if not thinned).
+int qmidinetThinner::index ( const unsigned char *data, unsigned short len )
+{
+	if (len < 2)
+		return -1;
+
+	const int channel = (data[0] & 0x0f);
+	switch (data[0] & 0xf0) {
+	case 0xa0: // Key pressure (aftertouch).
+		if (len < 3)
+			return -1;
+		return channel * NumSlots + 128 + (data[1] & 0x7f);
+	case 0xb0: { // Controllers (continuous only).
+		if (len < 3)
+			return -1;
+		const int controller = (data[1] & 0x7f);
+		if (controller == 0x00 || controller == 0x20	// Bank select.
+			|| controller == 0x06 || controller == 0x26	// Data entry.
+			|| (controller >= 0x40 && controller <= 0x45)	// Switches.
+			|| (controller >= 0x60 && controller <= 0x65)	// (N)RPN.
+			|| controller >= 0x78)	// Channel mode.
+			return -1;
+		return channel * NumSlots + controller;
+	}
+	case 0xd0: // Channel pressure.
+		return channel * NumSlots + 256;
+	case 0xe0: // Pitch bend.
+		if (len < 3)
+			return -1;
+		return channel * NumSlots + 257;
+	default:
+		return -1;
+	}
+}
+
+
+// Whether a single MIDI message is to be let through now.
+bool qmidinetThinner::accept (
+	const unsigned char *data, unsigned short len, int port )
+{
+	if (m_pSlots == nullptr || port < 0 || port >= m_nports)
+		return true;
+
+	const int i = index(data, len);
+	if (i < 0)
+		return true;
+
+	QMutexLocker locker(&m_mutex);
+
+	if (m_pSlots == nullptr)
+		return true;
+
+	Slot& slot = m_pSlots[port * 16 * NumSlots + i];
+	const unsigned int t = now();
+	if (t - slot.time >= m_period || !isCongested(t)) {
+		// Due (or uncongested): pass this one, superseding any pending...
+		slot.time = t;
+		if (slot.pending) {
+			slot.pending = 0;
+			--m_pPending[port];
+		}
+		return true;
+	}
+
+	// Not due: keep the newest value only...
+	::memcpy(slot.data, data, (len < 3 ? len : 3));
+	if (!slot.pending) {
+		slot.pending = (len < 3 ? len : 3);
+		++m_pPending[port];
+	}
+	else slot.pending = (len < 3 ? len : 3);
+
+	return false;
+}
+
+
+// Whether a port has any pending (coalesced) messages.
+bool qmidinetThinner::isPending ( int port ) const
+{
+	return (m_pPending && port >= 0 && port < m_nports
+		&& m_pPending[port] > 0);
+}
+
+
+// Pending messages, now due, as raw MIDI.
+unsigned short qmidinetThinner::flush (
+	int port, unsigned char *data, unsigned short size )
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_pSlots == nullptr || port < 0 || port >= m_nports
+		|| m_pPending[port] < 1)
+		return 0;
+
+	unsigned short len = 0;
+	const unsigned int t = now();
+	Slot *pSlots = m_pSlots + port * 16 * NumSlots;
+	for (int i = 0; i < 16 * NumSlots; ++i) {
+		Slot& slot = pSlots[i];
+		if (!slot.pending || t - slot.time < m_period)
+			continue;
+		if (len + slot.pending > size)
+			break;
+		::memcpy(data + len, slot.data, slot.pending);
+		len += slot.pending;
+		slot.time = t;
+		slot.pending = 0;
+		--m_pPending[port];
+	}
+
+	return len;
+}
+
+
+// end of qmidinetThinner.cpp
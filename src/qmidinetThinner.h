@@ -0,0 +1,127 @@
+// qmidinetThinner.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetThinner_h
+#define __qmidinetThinner_h
+
+#include <QMutex>
+#include <QElapsedTimer>
+
+
+//----------------------------------------------------------------------------
+// qmidinetThinner -- Continuous controller thinning (rate capped).
+//
+// Controllers, pitch bend and aftertouch are kept in a latest-value slot
+// table, per port, channel and controller (or key); while congested, each
+// slot lets one message through per rate period, at most, while newer ones
+// overwrite any pending value, to be flushed later. Everything else passes
+// untouched, as do order-critical controllers (bank select, data entry,
+// (N)RPN, switch pedals and channel mode messages).
+//
+// Congestion is signalled from outside (eg. on failed sends or a growing
+// backlog) and lasts for CongestTime since last signalled; unless the rate
+// cap is set to always apply, nothing gets thinned otherwise.
+
+class qmidinetThinner
+{
+public:
+
+	// Constructor.
+	qmidinetThinner();
+
+	// Destructor.
+	~qmidinetThinner();
+
+	// Slot table (re)initializer (rate cap in Hz; none if zero),
+	// optionally capped always, whether congested or not.
+	void setup(int iNumPorts, int iRate, bool bAlways = false);
+
+	// Slot table terminator.
+	void clear();
+
+	// Whether there's any thinning at all.
+	bool isActive() const { return (m_pSlots != nullptr); }
+
+	// Rate period (microseconds).
+	unsigned int period() const { return m_period; }
+
+	// Congestion signal (pressure lasts for CongestTime).
+	void congest();
+
+	// Congestion hold time (milliseconds).
+	static const unsigned int CongestTime = 1000;
+
+	// Whether a single MIDI message is to be let through now;
+	// otherwise it gets coalesced, pending for a later flush.
+	bool accept(const unsigned char *data, unsigned short len, int port);
+
+	// Whether a port has any pending (coalesced) messages.
+	bool isPending(int port) const;
+
+	// Pending messages, now due, as raw MIDI (returns the number of bytes).
+	unsigned short flush(int port, unsigned char *data, unsigned short size);
+
+	// Slot index from a MIDI message (-1 if not thinned): the same
+	// for any newer value of the same channel and controller (or key).
+	static int index(const unsigned char *data, unsigned short len);
+
+protected:
+
+	// Current time (microseconds; wrapping).
+	unsigned int now() const
+		{ return (unsigned int) (m_timer.nsecsElapsed() / 1000); }
+
+	// Whether the rate cap applies now (locked).
+	bool isCongested(unsigned int t);
+
+private:
+
+	// Slots per channel: controllers, key pressure,
+	// pitch bend and channel pressure.
+	static const int NumSlots = 128 + 128 + 2;
+
+	// Latest-value slot.
+	struct Slot
+	{
+		unsigned int  time;     // last sent.
+		unsigned char data[3];  // newest pending message...
+		unsigned char pending;  // ...and its length (0 if none).
+	};
+
+	// Instance variables.
+	int           m_nports;
+	unsigned int  m_period;
+
+	bool          m_bAlways;
+	bool          m_bCongested;
+	unsigned int  m_congested;
+
+	Slot         *m_pSlots;
+	int          *m_pPending;
+
+	QElapsedTimer m_timer;
+	QMutex        m_mutex;
+};
+
+
+#endif	// __qmidinetThinner_h
+
+// end of qmidinetThinner.h
@@ -26,6 +26,11 @@
 #include <QNetworkInterface>
 #include <QByteArray>
 #include <QVariant>
+#include <QThread>
+
+#if defined(Q_OS_UNIX)
+#include <string.h>
+#endif
 
 #else
 
@@ -100,52 +105,79 @@ bool qmidinetUdpDeviceThread::runState (void) const
 // The main thread executive.
 void qmidinetUdpDeviceThread::run (void)
 {
-	m_bRunState = true;
+	qmidinetUdpDevice *pUdpDevice = qmidinetUdpDevice::getInstance();
 
-	while (m_bRunState) {
+	// Read no more than what all sender queues can take...
+	const int nreads_max = m_nports
+		* qmidinetScheduler::MaxSources * qmidinetScheduler::QueueSize;
 
-		// Wait for an network event...
-		fd_set fds;
-		FD_ZERO(&fds);
+	m_bRunState = true;
 
-		int i, fdmax = 0;
-		for(i = 0; i < m_nports; ++i) {
-			FD_SET(m_sockin[i], &fds);
-			if (m_sockin[i] > fdmax)
-				fdmax = m_sockin[i];
-		}
+	while (m_bRunState) {
 
-		// Set timeout period (1 second)...
+		// Set timeout period (1 second; or else
+		// the hold time, while holding an open SysEx)...
 		struct timeval tv;
 		tv.tv_sec  = 1;
 		tv.tv_usec = 0;
-
-		int s = ::select(fdmax + 1, &fds, nullptr, nullptr, &tv);
-		if (s < 0) {
-			::perror("select");
-			break;
-		}
-		if (s == 0)	{
-			// Timeout!
-			continue;
+		if (pUdpDevice->isHolding()) {
+			tv.tv_sec  = 0;
+			tv.tv_usec = 1000 * qmidinetScheduler::HoldTime;
 		}
 
-		// A Network event
-		for (i = 0; i < m_nports; ++i) {
-			if (FD_ISSET(m_sockin[i], &fds)) {
-				// Read from network...
-				unsigned char buf[1024];
-				struct sockaddr_in sender;
-				socklen_t slen = sizeof(sender);
-				int r = ::recvfrom(m_sockin[i], (char *) buf, sizeof(buf),
-					0, (struct sockaddr *) &sender, &slen);
-				if (r > 0)
-					qmidinetUdpDevice::getInstance()->recvData(buf, r, i);
-				else
-				if (r < 0)
-					::perror("recvfrom");
+		int i, nreads = 0;
+		while (nreads < nreads_max) {
+
+			// Wait for an network event...
+			fd_set fds;
+			FD_ZERO(&fds);
+
+			int fdmax = 0;
+			for (i = 0; i < m_nports; ++i) {
+				FD_SET(m_sockin[i], &fds);
+				if (m_sockin[i] > fdmax)
+					fdmax = m_sockin[i];
+			}
+
+			int s = ::select(fdmax + 1, &fds, nullptr, nullptr, &tv);
+			if (s < 0) {
+				::perror("select");
+				m_bRunState = false;
+				break;
+			}
+			if (s == 0)	{
+				// Timeout!
+				break;
+			}
+
+			// A Network event
+			for (i = 0; i < m_nports; ++i) {
+				if (FD_ISSET(m_sockin[i], &fds)) {
+					// Read from network...
+					unsigned char buf[qmidinetUdpPacket::MaxSize];
+					struct sockaddr_in sender;
+					socklen_t slen = sizeof(sender);
+					int r = ::recvfrom(m_sockin[i], (char *) buf, sizeof(buf),
+						0, (struct sockaddr *) &sender, &slen);
+					if (r > 0) {
+						pUdpDevice->recvData(buf, r, i,
+							(const unsigned char *) &sender.sin_addr, 4,
+							ntohs(sender.sin_port));
+						++nreads;
+					}
+					else
+					if (r < 0)
+						::perror("recvfrom");
+				}
 			}
+
+			// Anything else pending, right now?
+			tv.tv_sec  = 0;
+			tv.tv_usec = 0;
 		}
+
+		// Fair merge, in turn...
+		pUdpDevice->schedule();
 	}
 }
 
@@ -160,10 +192,15 @@ qmidinetUdpDevice *qmidinetUdpDevice::g_pDevice = nullptr;
 
 // Constructor.
 qmidinetUdpDevice::qmidinetUdpDevice ( QObject *pParent )
-	: QObject(pParent), m_nports(0),
+	: QObject(pParent), m_nports(0), m_bPolled(false),
+		m_iThinRate(0), m_bThinAlways(false), m_iDedupWindow(0),
+		m_bDedupDuplicates(false),
 		m_sockin(nullptr), m_sockout(nullptr)
 	#if defined(CONFIG_IPV6)
 		, m_udpport(nullptr)
+	#if defined(Q_OS_UNIX)
+		, m_addrout(nullptr), m_addrlen(0)
+	#endif
 	#else
 		, m_addrout(nullptr)
 		, m_pRecvThread(nullptr)
@@ -176,6 +213,16 @@ qmidinetUdpDevice::qmidinetUdpDevice ( QObject *pParent )
 #endif	// !CONFIG_IPV6
 
 	g_pDevice = this;
+
+	QObject::connect(&m_thinTimer,
+		SIGNAL(timeout()),
+		SLOT(thinFlush()));
+
+	m_holdTimer.setSingleShot(true);
+
+	QObject::connect(&m_holdTimer,
+		SIGNAL(timeout()),
+		SLOT(holdTimeout()));
 }
 
 // Destructor.
@@ -228,8 +275,14 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 	if (!sInterface.isEmpty())
 		iface = QNetworkInterface::interfaceFromName(sInterface);
 
-	// Set the number of ports.
+	// Set the number of ports (and their routing).
 	m_nports = iNumPorts;
+	if (!m_routing.compile(m_routes, m_nports))
+		fprintf(stderr, "open(routes): invalid port routing (ignored).\n");
+	if (!m_filter.compile(m_filters))
+		fprintf(stderr, "open(filters): invalid message filter (ignored).\n");
+	m_scheduler.setup(m_nports);
+	m_senders.setup();
 
 	// Allocate sockets and addresses...
 	int i;
@@ -245,6 +298,32 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 		m_udpport[i] = iUdpPort + i;
 	}
 
+#if defined(Q_OS_UNIX)
+	// Native destination addresses, for sending
+	// straight from any other thread...
+	m_addrout = new struct sockaddr_storage [m_nports];
+
+	for (i = 0; i < m_nports; ++i) {
+		::memset(&m_addrout[i], 0, sizeof(struct sockaddr_storage));
+		if (ipv6_protocol) {
+			struct sockaddr_in6 *sa6
+				= (struct sockaddr_in6 *) &m_addrout[i];
+			const Q_IPV6ADDR addr6 = m_udpaddr.toIPv6Address();
+			sa6->sin6_family = AF_INET6;
+			sa6->sin6_port = htons(m_udpport[i]);
+			::memcpy(&sa6->sin6_addr, &addr6, sizeof(sa6->sin6_addr));
+			m_addrlen = sizeof(struct sockaddr_in6);
+		} else {
+			struct sockaddr_in *sa4
+				= (struct sockaddr_in *) &m_addrout[i];
+			sa4->sin_family = AF_INET;
+			sa4->sin_port = htons(m_udpport[i]);
+			sa4->sin_addr.s_addr = htonl(m_udpaddr.toIPv4Address());
+			m_addrlen = sizeof(struct sockaddr_in);
+		}
+	}
+#endif
+
 	// Setup sockets and addreses...
 	//
 	for (i = 0; i < m_nports; ++i) {
@@ -274,9 +353,11 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 				<< m_sockin[i]->error()
 				<< m_sockin[i]->errorString();
 		}
-		QObject::connect(m_sockin[i],
-			SIGNAL(readyRead()),
-			SLOT(readPendingDatagrams()));
+		if (!m_bPolled) {
+			QObject::connect(m_sockin[i],
+				SIGNAL(readyRead()),
+				SLOT(readPendingDatagrams()));
+		}
 		// Bind output socket...
 		if (!m_sockout[i]->bind(ipv6_protocol
 				? QHostAddress::AnyIPv6
@@ -319,8 +400,14 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 	if (!aUdpAddr.isEmpty())
 		udp_addr = aUdpAddr.constData();
 
-	// Set the number of ports.
+	// Set the number of ports (and their routing).
 	m_nports = iNumPorts;
+	if (!m_routing.compile(m_routes, m_nports))
+		fprintf(stderr, "open(routes): invalid port routing (ignored).\n");
+	if (!m_filter.compile(m_filters))
+		fprintf(stderr, "open(filters): invalid message filter (ignored).\n");
+	m_scheduler.setup(m_nports);
+	m_senders.setup();
 
 	// Input socket stuff...
 	//
@@ -457,12 +544,24 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 	#endif
 	}
 
-	// Start listener thread...
-	m_pRecvThread = new qmidinetUdpDeviceThread(m_sockin, m_nports);
-	m_pRecvThread->start();
+	// Start listener thread (unless polled)...
+	if (!m_bPolled) {
+		m_pRecvThread = new qmidinetUdpDeviceThread(m_sockin, m_nports);
+		m_pRecvThread->start();
+	}
 
 #endif	// !CONFIG_IPV6
 
+	// Duplicate and echo suppression, if any...
+	m_dedup.setup(m_iDedupWindow, m_bDedupDuplicates);
+
+	// Controller thinning, if any...
+	m_thinner.setup(m_nports, m_iThinRate, m_bThinAlways);
+	if (m_thinner.isActive()) {
+		const int iPeriod = int(m_thinner.period() / 1000);
+		m_thinTimer.start(iPeriod > 0 ? iPeriod : 1);
+	}
+
 	// Done.
 	return true;
 }
@@ -471,6 +570,12 @@ bool qmidinetUdpDevice::open ( const QString& sInterface,
 // Device termination method.
 void qmidinetUdpDevice::close (void)
 {
+	m_thinTimer.stop();
+	m_thinner.clear();
+	m_dedup.clear();
+
+	m_holdTimer.stop();
+
 #if defined(CONFIG_IPV6)
 
 	if (m_sockin) {
@@ -498,6 +603,13 @@ void qmidinetUdpDevice::close (void)
 		m_udpport = nullptr;
 	}
 
+#if defined(Q_OS_UNIX)
+	if (m_addrout) {
+		delete [] m_addrout;
+		m_addrout = nullptr;
+	}
+#endif
+
 #else
 
 	if (m_sockin) {
@@ -535,13 +647,131 @@ void qmidinetUdpDevice::close (void)
 
 #endif	// !CONFIG_IPV6
 
+	m_scheduler.clear();
+	m_senders.clear();
+
 	m_nports = 0;
 }
 
 
-// Data transmission methods.
-bool qmidinetUdpDevice::sendData (
-	unsigned char *data, unsigned short len, int port ) const
+// Data transmission methods (filtered and routed).
+bool qmidinetUdpDevice::sendData ( unsigned char *data,
+	unsigned short len, int port, const void *pvSource ) const
+{
+	unsigned char buf[qmidinetFilter::MaxSize];
+	const unsigned char *pchData = m_filter.filter(
+		data, &len, port, qmidinetRoutes::Send, buf,
+		&m_thinner, &m_dedup, pvSource);
+	if (pchData == nullptr)
+		return false;
+
+	bool bSent = false;
+
+	unsigned int mask = m_routing.midiToNetwork(port);
+	for (int i = 0; mask && i < m_nports; ++i, mask >>= 1) {
+		if ((mask & 1) && sendPort(pchData, len, i))
+			bSent = true;
+	}
+
+	return bSent;
+}
+
+
+void qmidinetUdpDevice::recvData (
+	unsigned char *data, unsigned short len, int port )
+{
+	dispatch(data, len, port);
+}
+
+
+// Received data from a sender, queued for a fair merge.
+bool qmidinetUdpDevice::recvData ( unsigned char *data,
+	unsigned short len, int port,
+	const unsigned char *addr, unsigned short naddr, unsigned short sport )
+{
+	if (m_scheduler.enqueue(port, addr, naddr, sport, data, len))
+		return true;
+
+	// Make some room, in turn...
+	schedule();
+
+	return m_scheduler.enqueue(port, addr, naddr, sport, data, len);
+}
+
+
+// Dispatch queued data, in fair order (and reassembled, per sender).
+bool qmidinetUdpDevice::schedule (void)
+{
+	unsigned char buf[qmidinetUdpPacket::MaxSize];
+	unsigned short len = 0;
+
+	unsigned char addr[16];
+	unsigned short sport = 0;
+
+	unsigned char data[qmidinetSenders::MaxSize];
+
+	for (int i = 0; i < m_nports; ++i) {
+		while (m_scheduler.dequeue(i, buf, &len, addr, &sport)) {
+			const unsigned short n
+				= m_senders.process(i, addr, sport, buf, len, data);
+			if (n > 0)
+				dispatch(data, n, i);
+		}
+	}
+
+	return m_scheduler.isHolding();
+}
+
+
+// Whether it's holding on to a sender's open SysEx.
+bool qmidinetUdpDevice::isHolding (void) const
+{
+	return m_scheduler.isHolding();
+}
+
+
+// Received datagram dispatch (filtered and routed).
+void qmidinetUdpDevice::dispatch (
+	const unsigned char *data, unsigned short len, int port )
+{
+	unsigned int mask = m_routing.networkToMidi(port);
+	if (mask == 0)
+		return;
+
+	// Dropped messages go no further...
+	unsigned char buf[qmidinetFilter::MaxSize];
+	const unsigned char *pchData
+		= m_filter.filter(data, &len, port, qmidinetRoutes::Receive, buf);
+	if (pchData == nullptr)
+		return;
+
+	// Keep track of what's received, as
+	// it might get echoed back right away...
+	if (m_dedup.isActive()) {
+		qmidinetUdpPacketReader packet(pchData, len);
+		unsigned long delta = 0;
+		const unsigned char *pchEvent = nullptr;
+		unsigned short nevent = 0;
+		while (packet.read(&delta, &pchEvent, &nevent)) {
+			unsigned int ports = mask;
+			for (int i = 0; ports && i < m_nports; ++i, ports >>= 1) {
+				if (ports & 1)
+					m_dedup.received(pchEvent, nevent, i);
+			}
+		}
+	}
+
+	const QByteArray datagram((const char *) pchData, len);
+	for (int i = 0; mask && i < m_nports; ++i, mask >>= 1) {
+		if (mask & 1)
+			emit received(datagram, i);
+	}
+}
+
+
+// Network port data transmission (unrouted).
+bool qmidinetUdpDevice::sendPort (
+	const unsigned char *data, unsigned short len, int port ) const
 {
 	if (port < 0 || port >= m_nports)
 		return false;
@@ -553,6 +783,33 @@ bool qmidinetUdpDevice::sendData (
 	if (m_sockout[port] == nullptr)
 		return false;
 
+#if defined(Q_OS_UNIX)
+
+	// Send straight through the native socket...
+	const qintptr sockout = m_sockout[port]->socketDescriptor();
+	if (sockout < 0 || m_addrout == nullptr)
+		return false;
+
+	if (::sendto(int(sockout), (char *) data, len, 0,
+			(struct sockaddr *) &m_addrout[port], m_addrlen) < 0) {
+		::perror("sendto");
+		// Most likely a full send buffer...
+		m_thinner.congest();
+		return false;
+	}
+
+#else
+
+	// Sockets belong to the main thread...
+	if (QThread::currentThread() != QObject::thread()) {
+		QMetaObject::invokeMethod(
+			const_cast<qmidinetUdpDevice *> (this), "receive",
+			Qt::QueuedConnection,
+			Q_ARG(QByteArray, QByteArray((const char *) data, len)),
+			Q_ARG(int, port));
+		return true;
+	}
+
 	if (!m_sockout[port]->isValid()
 		|| m_sockout[port]->state() != QAbstractSocket::BoundState) {
 		qWarning() << "sendData(sockout):" << port
@@ -567,9 +824,12 @@ bool qmidinetUdpDevice::sendData (
 			<< "udp socket error"
 			<< m_sockout[port]->error() << " "
 			<< m_sockout[port]->errorString();
+		m_thinner.congest();
 		return false;
 	}
 
+#endif	// !Q_OS_UNIX
+
 #else
 
 	if (m_sockout == nullptr)
@@ -581,6 +841,8 @@ bool qmidinetUdpDevice::sendData (
 			(struct sockaddr *) &m_addrout[port],
 			sizeof(struct sockaddr_in)) < 0) {
 		::perror("sendto");
+		// Most likely a full send buffer...
+		m_thinner.congest();
 		return false;
 	}
 
@@ -590,17 +852,164 @@ bool qmidinetUdpDevice::sendData (
 }
 
 
-void qmidinetUdpDevice::recvData (
-	unsigned char *data, unsigned short len, int port )
+// Polled mode accessors.
+void qmidinetUdpDevice::setPolled ( bool bPolled )
+{
+	m_bPolled = bPolled;
+}
+
+bool qmidinetUdpDevice::isPolled (void) const
+{
+	return m_bPolled;
+}
+
+
+// Native input socket descriptor (-1 if none).
+int qmidinetUdpDevice::socketIn ( int port ) const
+{
+	if (m_sockin == nullptr || port < 0 || port >= m_nports)
+		return -1;
+
+#if defined(CONFIG_IPV6)
+	if (m_sockin[port] == nullptr)
+		return -1;
+	return int(m_sockin[port]->socketDescriptor());
+#else
+	return m_sockin[port];
+#endif
+}
+
+
+// Port routing accessors.
+void qmidinetUdpDevice::setRoutes ( const QStringList& routes )
+{
+	m_routes = routes;
+}
+
+const QStringList& qmidinetUdpDevice::routes (void) const
+{
+	return m_routes;
+}
+
+
+// Controller thinning rate cap accessors.
+void qmidinetUdpDevice::setThinRate ( int iThinRate )
+{
+	m_iThinRate = iThinRate;
+}
+
+int qmidinetUdpDevice::thinRate (void) const
+{
+	return m_iThinRate;
+}
+
+void qmidinetUdpDevice::setThinAlways ( bool bThinAlways )
+{
+	m_bThinAlways = bThinAlways;
+}
+
+bool qmidinetUdpDevice::isThinAlways (void) const
+{
+	return m_bThinAlways;
+}
+
+
+// Duplicate and echo suppression window accessors.
+void qmidinetUdpDevice::setDedupWindow ( int iDedupWindow )
+{
+	m_iDedupWindow = iDedupWindow;
+}
+
+int qmidinetUdpDevice::dedupWindow (void) const
+{
+	return m_iDedupWindow;
+}
+
+void qmidinetUdpDevice::setDedupDuplicates ( bool bDedupDuplicates )
+{
+	m_bDedupDuplicates = bDedupDuplicates;
+}
+
+bool qmidinetUdpDevice::isDedupDuplicates (void) const
 {
-	emit received(QByteArray((const char *) data, len), port);
+	return m_bDedupDuplicates;
 }
 
 
-// Receive data slot.
+// Runtime statistics (human readable).
+QString qmidinetUdpDevice::statistics (void) const
+{
+	QString sText;
+
+	if (m_senders.count() > 0) {
+		sText += tr("Network senders: %1, datagrams lost: %2, duplicate: %3.\n")
+			.arg(m_senders.count())
+			.arg(m_senders.lost())
+			.arg(m_senders.duplicates());
+	}
+
+	return sText;
+}
+
+
+// Source priorities accessors.
+void qmidinetUdpDevice::setPriorities ( const QStringList& priorities )
+{
+	m_scheduler.setPriorities(priorities);
+}
+
+const QStringList& qmidinetUdpDevice::priorities (void) const
+{
+	return m_scheduler.priorities();
+}
+
+
+// Open SysEx hold (timer) slot.
+void qmidinetUdpDevice::holdTimeout (void)
+{
+	if (schedule())
+		m_holdTimer.start(qmidinetScheduler::HoldTime);
+}
+
+
+// Controller thinning flush (timer) slot.
+void qmidinetUdpDevice::thinFlush (void)
+{
+	unsigned char buf[qmidinetUdpPacket::MaxSize];
+
+	for (int port = 0; port < m_nports; ++port) {
+		if (!m_thinner.isPending(port))
+			continue;
+		// Coalesced values go as raw MIDI (already filtered)...
+		const unsigned short len
+			= m_thinner.flush(port, buf, sizeof(buf));
+		if (len < 1)
+			continue;
+		unsigned int mask = m_routing.midiToNetwork(port);
+		for (int i = 0; mask && i < m_nports; ++i, mask >>= 1) {
+			if (mask & 1)
+				sendPort(buf, len, i);
+		}
+	}
+}
+
+
+// Message filter accessors.
+void qmidinetUdpDevice::setFilters ( const QStringList& filters )
+{
+	m_filters = filters;
+}
+
+const QStringList& qmidinetUdpDevice::filters (void) const
+{
+	return m_filters;
+}
+
+
+// Receive data slot (network port, already routed).
 void qmidinetUdpDevice::receive ( QByteArray data, int port )
 {
-	sendData((unsigned char *) data.constData(), data.length(), port);
+	sendPort((const unsigned char *) data.constData(), data.length(), port);
 }
 
 
@@ -614,16 +1023,22 @@ void qmidinetUdpDevice::readPendingDatagrams (void)
 
 	for (int i = 0; i < m_nports; ++i) {
 		while (m_sockin[i] && m_sockin[i]->hasPendingDatagrams()) {
-			QByteArray datagram;
-			int nread = m_sockin[i]->pendingDatagramSize();
-			datagram.resize(nread);
-			nread = m_sockin[i]->readDatagram(datagram.data(), datagram.size());
+			unsigned char buf[qmidinetUdpPacket::MaxSize];
+			QHostAddress sender;
+			quint16 sport = 0;
+			const qint64 nread = m_sockin[i]->readDatagram(
+				(char *) buf, sizeof(buf), &sender, &sport);
 			if (nread > 0) {
-				datagram.resize(nread);
-				emit received(datagram, i);
+				// Queued per source (IPv4-mapped, if any)...
+				const Q_IPV6ADDR& addr = sender.toIPv6Address();
+				recvData(buf, (unsigned short) nread, i, addr.c, 16, sport);
 			}
 		}
 	}
+
+	// Fair merge, in turn...
+	if (schedule() && !m_holdTimer.isActive())
+		m_holdTimer.start(qmidinetScheduler::HoldTime);
 }
 
 #else
@@ -23,6 +23,9 @@
 #define __qmidinetUdpDevice_h
 
 #include "qmidinetAbout.h"
+#include "qmidinetFilter.h"
+#include "qmidinetScheduler.h"
+#include "qmidinetSenders.h"
 
 #include <stdio.h>
 
@@ -37,10 +40,15 @@
 
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
 #if defined(CONFIG_IPV6)
 #include <QUdpSocket>
 #include <QHostAddress>
+#if defined(Q_OS_UNIX)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
 #endif
 
 
@@ -69,10 +77,89 @@ public:
 	// Device termination method.
 	void close();
 
-	// Data transmission methods.
-	bool sendData(unsigned char *data, unsigned short len, int port = 0) const;
+	// Data transmission methods (thread-safe);
+	// ports are the MIDI ones, as routed to/from the network;
+	// sent data source is the MIDI backend (for deduplication).
+	bool sendData(unsigned char *data, unsigned short len, int port = 0,
+		const void *pvSource = nullptr) const;
 	void recvData(unsigned char *data, unsigned short len, int port = 0);
 
+	// Received data from a sender (address and port), queued for
+	// a fair merge, to be dispatched on schedule (same thread only).
+	bool recvData(unsigned char *data, unsigned short len, int port,
+		const unsigned char *addr, unsigned short naddr, unsigned short sport);
+
+	// Dispatch queued data, in fair order; whether it's still
+	// holding on to a sender's open SysEx, to be resumed later.
+	bool schedule();
+
+	// Whether it's holding on to a sender's open SysEx.
+	bool isHolding() const;
+
+	// Port routing accessors: when set (before opening),
+	// replaces the default one-to-one port routing.
+	void setRoutes(const QStringList& routes);
+	const QStringList& routes() const;
+
+	// Compiled port routing table.
+	const qmidinetRoutes& routing() const { return m_routing; }
+
+	// Message filter accessors: when set (before opening),
+	// drops matching messages, as soon as sent or received.
+	void setFilters(const QStringList& filters);
+	const QStringList& filters() const;
+
+	// Compiled message filter.
+	const qmidinetFilter& filter() const { return m_filter; }
+
+	// Controller thinning rate cap accessors (Hz; none if zero):
+	// when set (before opening), continuous controllers are sent
+	// no more often than this, per port, channel and controller,
+	// while congested (or always, when explicitly set so).
+	void setThinRate(int iThinRate);
+	int thinRate() const;
+
+	void setThinAlways(bool bThinAlways);
+	bool isThinAlways() const;
+
+	// Congestion signal (eg. a MIDI backend falling behind).
+	void congest() const { m_thinner.congest(); }
+
+	// Duplicate and echo suppression window accessors (msecs; none if
+	// zero): when set (before opening), the same event just received
+	// from the network is dropped, as is the same one sent from another
+	// MIDI backend, if duplicates are to be dropped too.
+	void setDedupWindow(int iDedupWindow);
+	int dedupWindow() const;
+
+	void setDedupDuplicates(bool bDedupDuplicates);
+	bool isDedupDuplicates() const;
+
+	// Duplicate and echo suppression stage.
+	qmidinetDedup& dedup() const { return m_dedup; }
+
+	// Source priorities accessors: when set (before opening), senders
+	// get more datagrams per turn merged, than the others ("ADDR=N").
+	void setPriorities(const QStringList& priorities);
+	const QStringList& priorities() const;
+
+	// Fair multi-source merge scheduler (polled mode).
+	qmidinetScheduler& scheduler() { return m_scheduler; }
+
+	// Per-sender stream state table (polled mode).
+	qmidinetSenders& senders() { return m_senders; }
+
+	// Runtime statistics (human readable).
+	QString statistics() const;
+
+	// Polled mode accessors: when set (before opening), input sockets
+	// are left alone, to be read (non-blocking) by someone else.
+	void setPolled(bool bPolled);
+	bool isPolled() const;
+
+	// Native input socket descriptor (-1 if none).
+	int socketIn(int port = 0) const;
+
 signals:
 
 	// Received data signal.
@@ -83,9 +170,24 @@ public slots:
 	// Receive data slot.
 	void receive(QByteArray data, int port);
 
-#if defined(CONFIG_IPV6)
+protected:
+
+	// Network port data transmission (unrouted).
+	bool sendPort(const unsigned char *data, unsigned short len, int port) const;
+
+	// Received datagram dispatch (filtered and routed).
+	void dispatch(const unsigned char *data, unsigned short len, int port);
+
 protected slots:
 
+	// Controller thinning flush (timer) slot.
+	void thinFlush();
+
+	// Open SysEx hold (timer) slot.
+	void holdTimeout();
+
+#if defined(CONFIG_IPV6)
+
 	// Process incoming datagrams.
 	void readPendingDatagrams();
 
@@ -102,6 +204,37 @@ private:
 	// Instance variables,
 	int  m_nports;
 
+	bool m_bPolled;
+
+	// Port routing (textual and compiled).
+	QStringList    m_routes;
+	qmidinetRoutes m_routing;
+
+	// Message filter (textual and compiled).
+	QStringList    m_filters;
+	qmidinetFilter m_filter;
+
+	// Controller thinning (rate cap and slot table).
+	int    m_iThinRate;
+	bool   m_bThinAlways;
+	QTimer m_thinTimer;
+
+	mutable qmidinetThinner m_thinner;
+
+	// Duplicate and echo suppression (time window and hash table).
+	int  m_iDedupWindow;
+	bool m_bDedupDuplicates;
+
+	mutable qmidinetDedup m_dedup;
+
+	// Fair multi-source merge (per sender queues).
+	qmidinetScheduler m_scheduler;
+
+	// Per-sender stream state (reassembly).
+	qmidinetSenders m_senders;
+
+	QTimer m_holdTimer;
+
 #if defined(CONFIG_IPV6)
 
 	QUdpSocket **m_sockin;
@@ -111,6 +244,12 @@ private:
 
 	int *m_udpport;
 
+#if defined(Q_OS_UNIX)
+	// Native destination addresses (thread-safe sends).
+	struct sockaddr_storage *m_addrout;
+	socklen_t m_addrlen;
+#endif
+
 #else
 
 	int *m_sockin;
@@ -0,0 +1,450 @@
+// qmidinetUdpPacket.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetUdpPacket.h"
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// Variable-length quantity helpers (as in SMF, up to 28 bits).
+
+static unsigned short qmidinetUdpPacket_vlq_size ( unsigned long val )
+{
+	unsigned short n = 1;
+	while ((val >>= 7) > 0 && n < 4)
+		++n;
+	return n;
+}
+
+static unsigned char *qmidinetUdpPacket_vlq_write (
+	unsigned char *p, unsigned long val )
+{
+	const unsigned short n = qmidinetUdpPacket_vlq_size(val);
+	for (unsigned short i = n; i > 1; --i)
+		*p++ = 0x80 | ((val >> (7 * (i - 1))) & 0x7f);
+	*p++ = (val & 0x7f);
+	return p;
+}
+
+static bool qmidinetUdpPacket_vlq_read (
+	const unsigned char *data, unsigned short len,
+	unsigned short *pos, unsigned long *val )
+{
+	unsigned long v = 0;
+	for (unsigned short n = 0; n < 4 && *pos < len; ++n) {
+		const unsigned char c = data[(*pos)++];
+		v = (v << 7) | (c & 0x7f);
+		if ((c & 0x80) == 0) {
+			*val = v;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// MIDI message size, from its status byte (SysEx excepted).
+static unsigned short qmidinetUdpPacket_status_size ( unsigned char status )
+{
+	switch (status & 0xf0) {
+	case 0xc0:
+	case 0xd0:
+		return 2;
+	case 0xf0:
+		switch (status) {
+		case 0xf1:
+		case 0xf3:
+			return 2;
+		case 0xf2:
+			return 3;
+		default:
+			return 1;
+		}
+	default:
+		return 3;
+	}
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacket -- Network datagram formats.
+
+// Datagram format probe.
+qmidinetUdpPacket::Format qmidinetUdpPacket::format (
+	const unsigned char *data, unsigned short len )
+{
+	if (len >= TimedHeaderSize
+		&& data[0] == TimedMarker
+		&& data[1] == TimedVersion)
+		return Timed;
+	else
+	if (len >= UmpHeaderSize
+		&& data[0] == UmpMarker
+		&& data[1] == UmpVersion)
+		return Ump;
+	else
+		return Raw;
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacketWriter -- Time-stamped (or UMP) datagram builder.
+
+// Constructor.
+qmidinetUdpPacketWriter::qmidinetUdpPacketWriter (void)
+	: m_format(qmidinetUdpPacket::Timed), m_port(0),
+		m_len(0), m_count(0), m_seqno(0), m_time(0)
+{
+}
+
+
+// Datagram format (time-stamped, or else UMP) and port accessors.
+void qmidinetUdpPacketWriter::setFormat (
+	qmidinetUdpPacket::Format format, unsigned char port )
+{
+	m_format = (format == qmidinetUdpPacket::Ump
+		? qmidinetUdpPacket::Ump : qmidinetUdpPacket::Timed);
+	m_port = port;
+
+	clear();
+}
+
+
+// Discard current contents (a new datagram begins on next write).
+void qmidinetUdpPacketWriter::clear (void)
+{
+	m_len = 0;
+	m_count = 0;
+}
+
+
+// Begin a time-stamped datagram with the given header.
+void qmidinetUdpPacketWriter::begin ( unsigned short seqno, unsigned long time )
+{
+	if (m_format != qmidinetUdpPacket::Timed)
+		return;
+
+	clear();
+
+	unsigned char *p = m_data;
+	*p++ = qmidinetUdpPacket::TimedMarker;
+	*p++ = qmidinetUdpPacket::TimedVersion;
+	*p++ = (seqno >> 8) & 0xff;
+	*p++ = (seqno & 0xff);
+	*p++ = (time >> 24) & 0xff;
+	*p++ = (time >> 16) & 0xff;
+	*p++ = (time >> 8) & 0xff;
+	*p++ = (time & 0xff);
+
+	m_len = qmidinetUdpPacket::TimedHeaderSize;
+	m_seqno = seqno + 1;
+	m_time = time;
+}
+
+
+// Append an event stamped at the given sender time (microseconds).
+bool qmidinetUdpPacketWriter::write (
+	unsigned long time, const unsigned char *data, unsigned short len )
+{
+	if (m_format == qmidinetUdpPacket::Ump) {
+		// One packet at a time, all or none...
+		const unsigned short len0 = m_len;
+		const int count0 = m_count;
+		unsigned int ump[qmidinetUmp::MaxWords];
+		unsigned short i = 0;
+		while (i < len) {
+			unsigned short n = 0;
+			const unsigned short nwords
+				= qmidinetUmp::encodeNext(data + i, len - i, 0, ump, &n);
+			if (nwords < 1 || !writeUmp(ump, nwords)) {
+				m_len = len0;
+				m_count = count0;
+				return false;
+			}
+			i += n;
+		}
+		m_count = count0 + 1;
+		return (i > 0);
+	}
+
+	// Header already in place (see begin())?
+	const bool begin = (m_len < 1);
+	const unsigned long base_time = (begin ? time : m_time);
+
+	// Delta-times are never negative (but may wrap around)...
+	unsigned long delta = (time - base_time) & 0xffffffffUL;
+	if (delta >= 0x80000000UL)
+		delta = 0;
+	else
+	if (delta > 0x0fffffffUL)
+		delta = 0x0fffffffUL;
+
+	const unsigned int size = qmidinetUdpPacket_vlq_size(delta)
+		+ qmidinetUdpPacket_vlq_size(len) + len;
+	unsigned int offset = m_len;
+	if (begin)
+		offset = qmidinetUdpPacket::TimedHeaderSize;
+	if (offset + size > qmidinetUdpPacket::MaxSize)
+		return false;
+
+	unsigned char *p = m_data;
+	if (begin) {
+		// Begin a new datagram...
+		*p++ = qmidinetUdpPacket::TimedMarker;
+		*p++ = qmidinetUdpPacket::TimedVersion;
+		*p++ = (m_seqno >> 8) & 0xff;
+		*p++ = (m_seqno & 0xff);
+		*p++ = (time >> 24) & 0xff;
+		*p++ = (time >> 16) & 0xff;
+		*p++ = (time >> 8) & 0xff;
+		*p++ = (time & 0xff);
+		++m_seqno;
+	}
+	else p += m_len;
+
+	p = qmidinetUdpPacket_vlq_write(p, delta);
+	p = qmidinetUdpPacket_vlq_write(p, len);
+	::memcpy(p, data, len);
+
+	m_len = offset + size;
+	m_time = base_time + delta;
+	++m_count;
+
+	return true;
+}
+
+
+// Append UMP packets, as they are (UMP datagrams only).
+bool qmidinetUdpPacketWriter::writeUmp (
+	const unsigned int *ump, unsigned short nwords )
+{
+	if (m_format != qmidinetUdpPacket::Ump)
+		return false;
+
+	const bool begin = (m_count < 1);
+
+	const unsigned int size = 4 * nwords;
+	unsigned int offset = m_len;
+	if (begin)
+		offset = qmidinetUdpPacket::UmpHeaderSize;
+	if (offset + size > qmidinetUdpPacket::MaxSize)
+		return false;
+
+	unsigned char *p = m_data;
+	if (begin) {
+		// Begin a new datagram...
+		*p++ = qmidinetUdpPacket::UmpMarker;
+		*p++ = qmidinetUdpPacket::UmpVersion;
+		*p++ = m_port;
+		*p++ = 0;
+	}
+	else p += m_len;
+
+	for (unsigned short i = 0; i < nwords; ++i) {
+		const unsigned int w = ump[i];
+		*p++ = (w >> 24) & 0xff;
+		*p++ = (w >> 16) & 0xff;
+		*p++ = (w >> 8) & 0xff;
+		*p++ = (w & 0xff);
+	}
+
+	m_len = offset + size;
+	++m_count;
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacketReader -- Datagram event iterator.
+
+// Constructor.
+qmidinetUdpPacketReader::qmidinetUdpPacketReader (
+	const unsigned char *data, unsigned short len )
+	: m_data(data), m_len(len), m_pos(0),
+		m_format(qmidinetUdpPacket::format(data, len)),
+		m_seqno(0), m_timestamp(0), m_status(0), m_nmsg(0),
+		m_sysex(true), m_port(0)
+{
+	if (m_format == qmidinetUdpPacket::Timed) {
+		m_seqno = (m_data[2] << 8) | m_data[3];
+		m_timestamp = (((unsigned long) m_data[4]) << 24)
+			| (((unsigned long) m_data[5]) << 16)
+			| (((unsigned long) m_data[6]) << 8)
+			| ((unsigned long) m_data[7]);
+		m_pos = qmidinetUdpPacket::TimedHeaderSize;
+	}
+	else
+	if (m_format == qmidinetUdpPacket::Ump) {
+		m_port = m_data[2];
+		m_pos = qmidinetUdpPacket::UmpHeaderSize;
+	}
+}
+
+
+// Next event, with its delta time (microseconds);
+// raw datagrams are split into single complete messages,
+// with any running status restored (delta time is nil),
+// real-time ones as they come, even within others, and SysEx
+// continuation chunks (leading data bytes) as they are;
+// UMP ones are translated to MIDI 1.0 (delta time is nil).
+bool qmidinetUdpPacketReader::read ( unsigned long *delta,
+	const unsigned char **data, unsigned short *len )
+{
+	if (m_pos >= m_len)
+		return false;
+
+	if (m_format == qmidinetUdpPacket::Raw) {
+		*delta = 0;
+		return readRaw(data, len);
+	}
+
+	if (m_format == qmidinetUdpPacket::Ump) {
+		*delta = 0;
+		unsigned int ump[qmidinetUmp::MaxWords];
+		unsigned short nwords = 0;
+		while (readUmp(ump, &nwords)) {
+			const unsigned short n = qmidinetUmp::decode(ump, m_decoded);
+			if (n > 0) {
+				*data = m_decoded;
+				*len = n;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned long size = 0;
+	if (!qmidinetUdpPacket_vlq_read(m_data, m_len, &m_pos, delta)
+		|| !qmidinetUdpPacket_vlq_read(m_data, m_len, &m_pos, &size)
+		|| size < 1 || m_pos + size > m_len) {
+		// Malformed/truncated datagram...
+		m_pos = m_len;
+		return false;
+	}
+
+	*data = m_data + m_pos;
+	*len = (unsigned short) size;
+	m_pos += size;
+
+	return true;
+}
+
+
+// Next UMP packet, as it is (UMP datagrams only).
+bool qmidinetUdpPacketReader::readUmp (
+	unsigned int *ump, unsigned short *nwords )
+{
+	if (m_format != qmidinetUdpPacket::Ump)
+		return false;
+
+	if (m_pos + 4 > m_len) {
+		m_pos = m_len;
+		return false;
+	}
+
+	const unsigned char *p = m_data + m_pos;
+	const unsigned short n = qmidinetUmp::packetSize(
+		(((unsigned int) p[0]) << 24) | (((unsigned int) p[1]) << 16));
+	if (m_pos + 4 * n > m_len) {
+		// Malformed/truncated datagram...
+		m_pos = m_len;
+		return false;
+	}
+
+	for (unsigned short i = 0; i < n; ++i, p += 4) {
+		ump[i] = (((unsigned int) p[0]) << 24)
+			| (((unsigned int) p[1]) << 16)
+			| (((unsigned int) p[2]) << 8)
+			| ((unsigned int) p[3]);
+	}
+
+	*nwords = n;
+	m_pos += 4 * n;
+
+	return true;
+}
+
+
+// Next raw MIDI message.
+bool qmidinetUdpPacketReader::readRaw (
+	const unsigned char **data, unsigned short *len )
+{
+	while (m_pos < m_len) {
+		const unsigned char *p = m_data + m_pos;
+		const unsigned short avail = m_len - m_pos;
+		const unsigned char c = p[0];
+		if (c >= 0xf8) {
+			// Real-time, anywhere (whatever's being assembled is kept)...
+			++m_pos;
+			*data = p;
+			*len = 1;
+			return true;
+		}
+		if (c == 0xf0 || (c < 0x80 && m_sysex && m_nmsg < 1)) {
+			// SysEx, or else its continuation (from a previous
+			// datagram), up to its end (or else the datagram's)...
+			unsigned short n = (c == 0xf0 ? 1 : 0);
+			while (n < avail && p[n] != 0xf7)
+				++n;
+			if (n < avail)
+				++n;
+			m_status = 0;
+			m_nmsg = 0;
+			m_sysex = (p[n - 1] != 0xf7);
+			m_pos += n;
+			*data = p;
+			*len = n;
+			return true;
+		}
+		++m_pos;
+		if (c >= 0x80) {
+			// New status (running, unless system common);
+			// anything incomplete so far is skipped...
+			m_msg[0] = c;
+			m_nmsg = 1;
+			m_status = (c < 0xf0 ? c : 0);
+			m_sysex = false;
+		} else {
+			// Data bytes, on running status...
+			if (m_nmsg < 1) {
+				if (m_status < 0x80)
+					continue; // Stray data byte, skip it.
+				m_msg[0] = m_status;
+				m_nmsg = 1;
+			}
+			m_msg[m_nmsg++] = c;
+		}
+		// Complete message?
+		if (m_nmsg >= qmidinetUdpPacket_status_size(m_msg[0])) {
+			*data = m_msg;
+			*len = m_nmsg;
+			m_nmsg = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// end of qmidinetUdpPacket.cpp
@@ -0,0 +1,189 @@
+// qmidinetUdpPacket.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetUdpPacket_h
+#define __qmidinetUdpPacket_h
+
+#include "qmidinetUmp.h"
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacket -- Network datagram formats.
+//
+// Raw datagrams carry plain MIDI bytes, as ever (ipMIDI compatible),
+// possibly more than one message each (in running status even).
+//
+// Time-stamped datagrams start with an undefined MIDI real-time status
+// byte (0xfd), as a marker, followed by a version byte, a 16-bit sequence
+// number and a 32-bit sender timestamp (microseconds, wrapping), both in
+// network byte order; then each event follows as a variable-length delta
+// time (microseconds, since the previous event or the timestamp for the
+// first one), a variable-length size and its raw MIDI bytes.
+//
+// UMP datagrams start with another undefined MIDI status byte (0xf4),
+// as a marker, followed by a version byte, the port number and a reserved
+// byte; then MIDI 2.0 Universal MIDI Packets follow, as 32-bit words in
+// network byte order, each one carrying its own group and message type.
+
+class qmidinetUdpPacket
+{
+public:
+
+	// Wire formats.
+	enum Format { Raw = 0, Timed = 1, Ump = 2 };
+
+	// Maximum datagram size (as read by receivers).
+	static const unsigned short MaxSize = 1024;
+
+	// Time-stamped datagram marker and version.
+	static const unsigned char TimedMarker  = 0xfd;
+	static const unsigned char TimedVersion = 1;
+
+	// Time-stamped datagram header size.
+	static const unsigned short TimedHeaderSize = 8;
+
+	// UMP datagram marker, version and header size.
+	static const unsigned char UmpMarker  = 0xf4;
+	static const unsigned char UmpVersion = 1;
+
+	static const unsigned short UmpHeaderSize = 4;
+
+	// Datagram format probe.
+	static Format format(const unsigned char *data, unsigned short len);
+};
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacketWriter -- Time-stamped (or UMP) datagram builder.
+
+class qmidinetUdpPacketWriter
+{
+public:
+
+	// Constructor.
+	qmidinetUdpPacketWriter();
+
+	// Datagram format (time-stamped, or else UMP) and port accessors.
+	void setFormat(qmidinetUdpPacket::Format format, unsigned char port = 0);
+	qmidinetUdpPacket::Format format() const { return m_format; }
+
+	// Discard current contents (a new datagram begins on next write).
+	void clear();
+
+	// Begin a time-stamped datagram with the given header (as when
+	// rewriting another one; the next events are relative to it).
+	void begin(unsigned short seqno, unsigned long time);
+
+	// Append an event stamped at the given sender time (microseconds);
+	// UMP datagrams get it translated, with no time-stamp at all.
+	bool write(unsigned long time, const unsigned char *data, unsigned short len);
+
+	// Append UMP packets, as they are (UMP datagrams only).
+	bool writeUmp(const unsigned int *ump, unsigned short nwords);
+
+	// Current datagram accessors.
+	unsigned char *data() { return m_data; }
+	unsigned short length() const { return m_len; }
+	int count() const { return m_count; }
+
+	bool isEmpty() const { return (m_count < 1); }
+
+private:
+
+	// Instance variables.
+	qmidinetUdpPacket::Format m_format;
+	unsigned char  m_port;
+
+	unsigned char  m_data[qmidinetUdpPacket::MaxSize];
+	unsigned short m_len;
+	int            m_count;
+	unsigned short m_seqno;
+	unsigned long  m_time;
+};
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacketReader -- Datagram event iterator.
+
+class qmidinetUdpPacketReader
+{
+public:
+
+	// Constructor.
+	qmidinetUdpPacketReader(const unsigned char *data, unsigned short len);
+
+	// Datagram properties.
+	qmidinetUdpPacket::Format format() const { return m_format; }
+
+	unsigned short seqno() const { return m_seqno; }
+	unsigned long timestamp() const { return m_timestamp; }
+
+	unsigned char port() const { return m_port; }
+
+	// Next event, with its delta time (microseconds);
+	// raw datagrams are split into single complete messages,
+	// with any running status restored (delta time is nil),
+	// real-time ones as they come, even within others, and SysEx
+	// continuation chunks (leading data bytes) as they are;
+	// UMP ones are translated to MIDI 1.0 (delta time is nil).
+	bool read(unsigned long *delta,
+		const unsigned char **data, unsigned short *len);
+
+	// Next UMP packet, as it is (UMP datagrams only;
+	// at least qmidinetUmp::MaxWords long).
+	bool readUmp(unsigned int *ump, unsigned short *nwords);
+
+	// Whether there's nothing left to read.
+	bool atEnd() const { return (m_pos >= m_len); }
+
+protected:
+
+	// Next raw MIDI message.
+	bool readRaw(const unsigned char **data, unsigned short *len);
+
+private:
+
+	// Instance variables.
+	const unsigned char *m_data;
+	unsigned short       m_len;
+	unsigned short       m_pos;
+
+	qmidinetUdpPacket::Format m_format;
+
+	unsigned short m_seqno;
+	unsigned long  m_timestamp;
+
+	// Raw running status, message being assembled
+	// and whether within SysEx (continued, maybe).
+	unsigned char  m_status;
+	unsigned char  m_msg[3];
+	unsigned short m_nmsg;
+	bool           m_sysex;
+
+	// UMP datagram port and translation.
+	unsigned char  m_port;
+	unsigned char  m_decoded[qmidinetUmp::MaxDecodeSize];
+};
+
+
+#endif	// __qmidinetUdpPacket_h
+
+// end of qmidinetUdpPacket.h
@@ -0,0 +1,313 @@
+// qmidinetUmp.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetUmp.h"
+
+
+//----------------------------------------------------------------------------
+// UMP message types (upper nibble of the first word).
+
+enum {
+	UmpUtility   = 0x0,
+	UmpSystem    = 0x1,
+	UmpMidi1     = 0x2,
+	UmpSysex7    = 0x3,
+	UmpMidi2     = 0x4,
+	UmpSysex8    = 0x5
+};
+
+// 7-bit SysEx packet status.
+enum {
+	UmpSysexComplete = 0x0,
+	UmpSysexStart    = 0x1,
+	UmpSysexContinue = 0x2,
+	UmpSysexEnd      = 0x3
+};
+
+
+// MIDI 1.0 message size, from its status byte (SysEx excepted).
+static unsigned short qmidinetUmp_status_size ( unsigned char status )
+{
+	switch (status & 0xf0) {
+	case 0xc0:
+	case 0xd0:
+		return 2;
+	case 0xf0:
+		switch (status) {
+		case 0xf1:
+		case 0xf3:
+			return 2;
+		case 0xf2:
+			return 3;
+		default:
+			return 1;
+		}
+	default:
+		return 3;
+	}
+}
+
+
+// Controller change, as MIDI 1.0 bytes.
+static unsigned char *qmidinetUmp_control (
+	unsigned char *p, unsigned char channel,
+	unsigned char param, unsigned char value )
+{
+	*p++ = 0xb0 | channel;
+	*p++ = param & 0x7f;
+	*p++ = value & 0x7f;
+	return p;
+}
+
+
+// MIDI 2.0 channel voice, scaled down to MIDI 1.0 bytes.
+static unsigned short qmidinetUmp_decode_midi2 (
+	const unsigned int *ump, unsigned char *data )
+{
+	const unsigned int w0 = ump[0];
+	const unsigned int w1 = ump[1];
+	const unsigned char status  = (w0 >> 16) & 0xf0;
+	const unsigned char channel = (w0 >> 16) & 0x0f;
+	const unsigned char index   = (w0 >> 8) & 0x7f;
+
+	unsigned char *p = data;
+	switch (status) {
+	case 0x80:	// Note off...
+	case 0x90:	// Note on...
+	{
+		unsigned char velocity = (w1 >> 25);
+		if (status == 0x90 && velocity == 0 && (w1 >> 16) > 0)
+			velocity = 1;
+		*p++ = status | channel;
+		*p++ = index;
+		*p++ = velocity;
+		break;
+	}
+	case 0xa0:	// Polyphonic key pressure...
+	case 0xb0:	// Controller...
+		*p++ = status | channel;
+		*p++ = index;
+		*p++ = (w1 >> 25);
+		break;
+	case 0xc0:	// Program change (and bank select, if valid)...
+		if (w0 & 0x01) {
+			p = qmidinetUmp_control(p, channel, 0x00, (w1 >> 8));
+			p = qmidinetUmp_control(p, channel, 0x20, w1);
+		}
+		*p++ = status | channel;
+		*p++ = (w1 >> 24) & 0x7f;
+		break;
+	case 0xd0:	// Channel pressure...
+		*p++ = status | channel;
+		*p++ = (w1 >> 25);
+		break;
+	case 0xe0:	// Pitch bend...
+	{
+		const unsigned short value = (w1 >> 18);
+		*p++ = status | channel;
+		*p++ = (value & 0x7f);
+		*p++ = (value >> 7) & 0x7f;
+		break;
+	}
+	case 0x20:	// Registered parameter (RPN)...
+	case 0x30:	// Assignable parameter (NRPN)...
+	{
+		const bool bRpn = (status == 0x20);
+		const unsigned short value = (w1 >> 18);
+		p = qmidinetUmp_control(p, channel, bRpn ? 0x65 : 0x63, (w0 >> 8));
+		p = qmidinetUmp_control(p, channel, bRpn ? 0x64 : 0x62, w0);
+		p = qmidinetUmp_control(p, channel, 0x06, (value >> 7));
+		p = qmidinetUmp_control(p, channel, 0x26, value);
+		break;
+	}
+	default:	// Per-note and relative messages have no equivalent.
+		break;
+	}
+
+	return (p - data);
+}
+
+
+// 7-bit SysEx packet to MIDI 1.0 bytes.
+static unsigned short qmidinetUmp_decode_sysex7 (
+	const unsigned int *ump, unsigned char *data )
+{
+	const unsigned char status = (ump[0] >> 20) & 0x0f;
+	unsigned short count = (ump[0] >> 16) & 0x0f;
+	if (count > 6)
+		count = 6;
+
+	unsigned char *p = data;
+	if (status == UmpSysexComplete || status == UmpSysexStart)
+		*p++ = 0xf0;
+	for (unsigned short i = 0; i < count; ++i) {
+		const unsigned int w = ump[(i + 2) >> 2];
+		*p++ = (w >> (8 * (3 - ((i + 2) & 3)))) & 0x7f;
+	}
+	if (status == UmpSysexComplete || status == UmpSysexEnd)
+		*p++ = 0xf7;
+
+	return (p - data);
+}
+
+
+// MIDI 1.0 SysEx (or a chunk thereof) to 7-bit SysEx packets.
+static unsigned short qmidinetUmp_encode_sysex7 (
+	const unsigned char *data, unsigned short len,
+	unsigned char group, unsigned int *ump )
+{
+	const bool bStart = (data[0] == 0xf0);
+	const bool bEnd = (data[len - 1] == 0xf7 && (len > 1 || !bStart));
+
+	const unsigned char *p = data;
+	unsigned short n = len;
+	if (bStart) { ++p; --n; }
+	if (bEnd) --n;
+
+	unsigned short nwords = 0;
+	bool bFirst = true;
+	do {
+		const unsigned short count = (n > 6 ? 6 : n);
+		const bool bLast = (count >= n);
+		unsigned char status;
+		if (bFirst && bStart)
+			status = (bLast && bEnd ? UmpSysexComplete : UmpSysexStart);
+		else
+			status = (bLast && bEnd ? UmpSysexEnd : UmpSysexContinue);
+		unsigned int w[2];
+		w[0] = (UmpSysex7 << 28) | (group << 24) | (status << 20) | (count << 16);
+		w[1] = 0;
+		for (unsigned short i = 0; i < count; ++i)
+			w[(i + 2) >> 2] |= (p[i] & 0x7f) << (8 * (3 - ((i + 2) & 3)));
+		ump[nwords++] = w[0];
+		ump[nwords++] = w[1];
+		p += count;
+		n -= count;
+		bFirst = false;
+	}
+	while (n > 0);
+
+	return nwords;
+}
+
+
+//----------------------------------------------------------------------------
+// qmidinetUmp -- MIDI 2.0 Universal MIDI Packet (UMP) helpers.
+
+// Packet size (words), from its first word.
+unsigned short qmidinetUmp::packetSize ( unsigned int word0 )
+{
+	static const unsigned short s_sizes[16]
+		= { 1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4 };
+
+	return s_sizes[(word0 >> 28) & 0x0f];
+}
+
+
+// One MIDI 1.0 message (or a SysEx chunk thereof) to UMP packets.
+unsigned short qmidinetUmp::encode ( const unsigned char *data,
+	unsigned short len, unsigned char group, unsigned int *ump )
+{
+	if (len < 1)
+		return 0;
+
+	group &= 0x0f;
+
+	const unsigned char status = data[0];
+	if (status == 0xf0 || status == 0xf7 || status < 0x80)
+		return qmidinetUmp_encode_sysex7(data, len, group, ump);
+
+	const unsigned short size = qmidinetUmp_status_size(status);
+	if (len < size)
+		return 0;
+
+	const unsigned int type = (status < 0xf0 ? UmpMidi1 : UmpSystem);
+	unsigned int w = (type << 28) | (group << 24) | (status << 16);
+	if (size > 1)
+		w |= (data[1] & 0x7f) << 8;
+	if (size > 2)
+		w |= (data[2] & 0x7f);
+	ump[0] = w;
+
+	return 1;
+}
+
+
+// One MIDI 1.0 message (or the next part of a SysEx) to one UMP packet.
+unsigned short qmidinetUmp::encodeNext ( const unsigned char *data,
+	unsigned short len, unsigned char group, unsigned int *ump,
+	unsigned short *pnext )
+{
+	*pnext = len;
+
+	if (len < 1)
+		return 0;
+
+	const unsigned char status = data[0];
+	if (status == 0xf0 || status == 0xf7 || status < 0x80) {
+		// Up to 6 data bytes per packet, plus the leading 0xf0,
+		// if starting, and the trailing 0xf7, if that's all left...
+		unsigned short n = (status == 0xf0 ? 7 : 6);
+		if (n + 1 == len && data[n] == 0xf7)
+			++n;
+		if (n < len)
+			*pnext = n;
+		else
+			n = len;
+		return qmidinetUmp_encode_sysex7(data, n, group & 0x0f, ump);
+	}
+
+	return encode(data, len, group, ump);
+}
+
+
+// One UMP packet to MIDI 1.0 bytes.
+unsigned short qmidinetUmp::decode (
+	const unsigned int *ump, unsigned char *data )
+{
+	const unsigned int w0 = ump[0];
+	const unsigned char status = (w0 >> 16) & 0xff;
+
+	switch ((w0 >> 28) & 0x0f) {
+	case UmpSystem:
+	case UmpMidi1:
+	{
+		if (status < 0x80 || status == 0xf0 || status == 0xf7)
+			return 0;
+		const unsigned short size = qmidinetUmp_status_size(status);
+		data[0] = status;
+		if (size > 1)
+			data[1] = (w0 >> 8) & 0x7f;
+		if (size > 2)
+			data[2] = (w0 & 0x7f);
+		return size;
+	}
+	case UmpSysex7:
+		return qmidinetUmp_decode_sysex7(ump, data);
+	case UmpMidi2:
+		return qmidinetUmp_decode_midi2(ump, data);
+	default:
+		return 0;
+	}
+}
+
+
+// end of qmidinetUmp.cpp
@@ -0,0 +1,79 @@
+// qmidinetUmp.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetUmp_h
+#define __qmidinetUmp_h
+
+
+//----------------------------------------------------------------------------
+// qmidinetUmp -- MIDI 2.0 Universal MIDI Packet (UMP) helpers.
+//
+// Packets are one to four 32-bit words, in host byte order; the message
+// type (upper nibble of the first word) tells its size. MIDI 1.0 bytes
+// are translated to MIDI 1.0 protocol packets (system, channel voice and
+// 7-bit SysEx); MIDI 2.0 channel voice is scaled down on the way back.
+
+class qmidinetUmp
+{
+public:
+
+	// Maximum packet size (words).
+	static const unsigned short MaxWords = 4;
+
+	// Maximum MIDI 1.0 size, out of one single packet
+	// (a 14-bit (N)RPN, as four controllers).
+	static const unsigned short MaxDecodeSize = 12;
+
+	// Packet size (words), from its first word.
+	static unsigned short packetSize(unsigned int word0);
+
+	// Packet group, from its first word.
+	static unsigned char group(unsigned int word0)
+		{ return (word0 >> 24) & 0x0f; }
+
+	// Maximum number of words a MIDI 1.0 message encodes to.
+	static unsigned short encodeSize(unsigned short len)
+		{ return 2 * (len / 6 + 1); }
+
+	// One MIDI 1.0 message (status included), or a SysEx chunk thereof,
+	// to UMP packets (at least encodeSize() words long) on some group.
+	// Returns the number of words (0 if undefined).
+	static unsigned short encode(const unsigned char *data,
+		unsigned short len, unsigned char group, unsigned int *ump);
+
+	// Same, but one single packet at a time (at least MaxWords long):
+	// the whole message, or else the next part of a SysEx; pnext gets
+	// the number of bytes taken. Returns the number of words (0 if
+	// undefined).
+	static unsigned short encodeNext(const unsigned char *data,
+		unsigned short len, unsigned char group, unsigned int *ump,
+		unsigned short *pnext);
+
+	// One UMP packet to MIDI 1.0 bytes (at least MaxDecodeSize long).
+	// Returns the number of bytes (0 if none).
+	static unsigned short decode(const unsigned int *ump,
+		unsigned char *data);
+};
+
+
+#endif	// __qmidinetUmp_h
+
+// end of qmidinetUmp.h
@@ -0,0 +1,118 @@
+// qmidinetd.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetd.h"
+
+#include "qmidinetOptions.h"
+
+#include <QTimer>
+
+
+//-------------------------------------------------------------------------
+// qmidinetDaemon -- Headless daemon instance (no GUI).
+//
+
+// Constructor.
+qmidinetDaemon::qmidinetDaemon ( QObject *pParent )
+	: QObject(pParent), m_engine(this)
+{
+	QObject::connect(&m_engine,
+		SIGNAL(error(const QString&, const QString&)),
+		SLOT(message(const QString&, const QString&)));
+#ifdef CONFIG_JACK_MIDI
+	QObject::connect(&m_engine,
+		SIGNAL(shutdown()),
+		SLOT(shutdown()));
+	QObject::connect(&m_engine,
+		SIGNAL(reconnected()),
+		SLOT(reconnected()));
+#endif
+}
+
+
+// Initializer.
+bool qmidinetDaemon::setup (void)
+{
+	return m_engine.setup(qmidinetOptions::getInstance());
+}
+
+
+// Restart/reset action (retries every minute, on failure).
+void qmidinetDaemon::reset (void)
+{
+	if (!setup())
+		QTimer::singleShot(60000, this, SLOT(reset()));
+}
+
+
+// Messager (log).
+void qmidinetDaemon::message (
+	const QString& sTitle, const QString& sText )
+{
+	const QString sMessage = sTitle + ": " + sText.simplified();
+	qCritical("%s", sMessage.toUtf8().constData());
+}
+
+
+#ifdef CONFIG_JACK_MIDI
+
+void qmidinetDaemon::shutdown (void)
+{
+	message(tr("JACK MIDI Inferface Error"),
+		tr("The JACK MIDI interface has been shutdown.\n\n"
+		"It will be reconnected as soon as the JACK MIDI sub-system "
+		"is reactivated."));
+}
+
+
+void qmidinetDaemon::reconnected (void)
+{
+	message(tr("JACK MIDI Inferface"),
+		tr("The JACK MIDI interface has been reconnected."));
+}
+
+#endif
+
+
+//-------------------------------------------------------------------------
+// main - The main program trunk (headless).
+//
+
+int main ( int argc, char* argv[] )
+{
+	QCoreApplication app(argc, argv);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+	app.setApplicationName(QMIDINET_TITLE);
+	app.setApplicationVersion(PROJECT_VERSION);
+#endif
+
+	qmidinetOptions opts;
+	if (!opts.parse_args(app.arguments()))
+		return 1;
+
+	qmidinetDaemon daemon;
+	daemon.reset();
+
+	return app.exec();
+}
+
+
+// end of qmidinetd.cpp
@@ -0,0 +1,68 @@
+// qmidinetd.h
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qmidinetd_h
+#define __qmidinetd_h
+
+#include "qmidinetEngine.h"
+
+#include <QCoreApplication>
+
+
+//-------------------------------------------------------------------------
+// qmidinetDaemon -- Headless daemon instance (no GUI).
+//
+
+class qmidinetDaemon : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qmidinetDaemon(QObject *pParent = nullptr);
+
+	// Initializers.
+	bool setup();
+
+public slots:
+
+	// Action slots...
+	void reset();
+
+	// Messager.
+	void message(const QString& sTitle, const QString& sText);
+
+#ifdef CONFIG_JACK_MIDI
+	void shutdown();
+	void reconnected();
+#endif
+
+private:
+
+	// The network bridge core.
+	qmidinetEngine m_engine;
+};
+
+
+#endif	// __qmidinetd_h
+
+// end of qmidinetd.h
@@ -0,0 +1,264 @@
+// qmidinetFilterTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetFilter.h"
+
+#include <QtTest>
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetFilterTest -- MIDI message filter tests.
+
+class qmidinetFilterTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	void validRules();
+	void acceptTypes();
+	void acceptPortsAndDirections();
+	void acceptControllers();
+	void acceptSysexContinuation();
+	void filterRaw();
+	void filterTimed();
+	void filterUmp();
+};
+
+
+// Short-hands.
+static const qmidinetRoutes::Direction In  = qmidinetRoutes::Receive;
+static const qmidinetRoutes::Direction Out = qmidinetRoutes::Send;
+
+
+// Textual rule parser.
+void qmidinetFilterTest::validRules (void)
+{
+	QVERIFY(qmidinetFilter::isValid(QStringList()));
+	QVERIFY(qmidinetFilter::isValid(QStringList() << "types=sensing,clock"));
+	QVERIFY(qmidinetFilter::isValid(QStringList() << "dir=in port=0-3 channels=1-4,10"));
+
+	QVERIFY(!qmidinetFilter::isValid(QStringList() << "types=bogus"));
+	QVERIFY(!qmidinetFilter::isValid(QStringList() << "port=0"));
+	QVERIFY(!qmidinetFilter::isValid(QStringList() << "channels=0"));
+	QVERIFY(!qmidinetFilter::isValid(QStringList() << "controllers=128"));
+	QVERIFY(!qmidinetFilter::isValid(QStringList() << "dir=sideways types=clock"));
+
+	// Malformed rules leave no rules at all...
+	qmidinetFilter filter;
+	QVERIFY(!filter.compile(QStringList() << "types=clock" << "types=bogus"));
+	QVERIFY(!filter.isActive(0, In) && !filter.isActive(0, Out));
+}
+
+
+// Message types, by name.
+void qmidinetFilterTest::acceptTypes (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "types=sensing,clock,note-on"));
+
+	const unsigned char sensing[] = { 0xfe };
+	const unsigned char clock[] = { 0xf8 };
+	const unsigned char start[] = { 0xfa };
+	const unsigned char note_on[] = { 0x95, 0x3c, 0x64 };
+	const unsigned char note_off[] = { 0x85, 0x3c, 0x00 };
+
+	QVERIFY(!filter.accept(sensing, sizeof(sensing), 0, In));
+	QVERIFY(!filter.accept(clock, sizeof(clock), 0, Out));
+	QVERIFY(!filter.accept(note_on, sizeof(note_on), 0, In));
+	QVERIFY(filter.accept(start, sizeof(start), 0, In));
+	QVERIFY(filter.accept(note_off, sizeof(note_off), 0, In));
+}
+
+
+// Ports and directions.
+void qmidinetFilterTest::acceptPortsAndDirections (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "dir=in port=1 channels=10"));
+
+	const unsigned char drums[] = { 0x99, 0x24, 0x64 };
+	const unsigned char piano[] = { 0x90, 0x3c, 0x64 };
+
+	QVERIFY(!filter.accept(drums, sizeof(drums), 1, In));
+	QVERIFY(filter.accept(drums, sizeof(drums), 1, Out));
+	QVERIFY(filter.accept(drums, sizeof(drums), 0, In));
+	QVERIFY(filter.accept(piano, sizeof(piano), 1, In));
+
+	QVERIFY(filter.isActive(1, In));
+	QVERIFY(!filter.isActive(1, Out) && !filter.isActive(0, In));
+}
+
+
+// Controller numbers (and conditions that can't apply).
+void qmidinetFilterTest::acceptControllers (void)
+{
+	const unsigned char volume[] = { 0xb1, 0x07, 0x64 };
+	const unsigned char volume1[] = { 0xb0, 0x07, 0x64 };
+	const unsigned char modwheel[] = { 0xb1, 0x01, 0x40 };
+	const unsigned char note[] = { 0x91, 0x3c, 0x64 };
+
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "controllers=7,64-67 channels=2"));
+	QVERIFY(!filter.accept(volume, sizeof(volume), 0, Out));
+	QVERIFY(filter.accept(volume1, sizeof(volume1), 0, Out));
+	QVERIFY(filter.accept(modwheel, sizeof(modwheel), 0, Out));
+	QVERIFY(filter.accept(note, sizeof(note), 0, Out));
+
+	// A controllers condition doesn't match notes...
+	QVERIFY(filter.compile(QStringList() << "types=note,controller controllers=7"));
+	QVERIFY(!filter.accept(volume, sizeof(volume), 0, Out));
+	QVERIFY(filter.accept(modwheel, sizeof(modwheel), 0, Out));
+	QVERIFY(filter.accept(note, sizeof(note), 0, Out));
+
+	// ...nor does a channels condition match clock.
+	const unsigned char clock[] = { 0xf8 };
+	QVERIFY(filter.compile(QStringList() << "types=clock,note channels=2"));
+	QVERIFY(filter.accept(clock, sizeof(clock), 0, Out));
+	QVERIFY(!filter.accept(note, sizeof(note), 0, Out));
+}
+
+
+// SysEx continuation chunks count as SysEx.
+void qmidinetFilterTest::acceptSysexContinuation (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "types=sysex"));
+
+	const unsigned char sysex[] = { 0xf0, 0x7e, 0x01 };
+	const unsigned char continuation[] = { 0x02, 0x03, 0xf7 };
+
+	QVERIFY(!filter.accept(sysex, sizeof(sysex), 0, In));
+	QVERIFY(!filter.accept(continuation, sizeof(continuation), 0, In));
+}
+
+
+// Raw datagrams get rewritten, with running status restored.
+void qmidinetFilterTest::filterRaw (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "types=sensing,clock"));
+
+	unsigned char buf[qmidinetFilter::MaxSize];
+
+	// Some dropped...
+	const unsigned char data[] = { 0xfe, 0x90, 0x3c, 0x64, 0x3e, 0x64, 0xf8 };
+	unsigned short len = sizeof(data);
+	const unsigned char *pchData = filter.filter(data, &len, 0, In, buf);
+	const unsigned char result[] = { 0x90, 0x3c, 0x64, 0x90, 0x3e, 0x64 };
+	QVERIFY(pchData == buf);
+	QCOMPARE(len, (unsigned short) sizeof(result));
+	QVERIFY(::memcmp(pchData, result, len) == 0);
+
+	// All dropped...
+	const unsigned char data2[] = { 0xfe, 0xf8 };
+	len = sizeof(data2);
+	QVERIFY(filter.filter(data2, &len, 0, In, buf) == nullptr);
+
+	// None dropped...
+	const unsigned char data3[] = { 0x90, 0x3c, 0x64 };
+	len = sizeof(data3);
+	QVERIFY(filter.filter(data3, &len, 0, In, buf) == data3);
+	QCOMPARE(len, (unsigned short) sizeof(data3));
+}
+
+
+// Time-stamped datagrams keep their original header and timing.
+void qmidinetFilterTest::filterTimed (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "types=clock"));
+
+	const unsigned char note[] = { 0x90, 0x3c, 0x64 };
+	const unsigned char clock[] = { 0xf8 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Timed);
+	writer.write(1000, clock, sizeof(clock));
+	writer.clear();
+	writer.write(2000, clock, sizeof(clock));
+	writer.write(2600, note, sizeof(note));
+	writer.write(2700, clock, sizeof(clock));
+	writer.write(3000, note, sizeof(note));
+
+	unsigned char buf[qmidinetFilter::MaxSize];
+	unsigned short len = writer.length();
+	const unsigned char *pchData = filter.filter(writer.data(), &len, 0, In, buf);
+	QVERIFY(pchData == buf);
+
+	qmidinetUdpPacketReader packet(pchData, len);
+	QVERIFY(packet.format() == qmidinetUdpPacket::Timed);
+	QCOMPARE(packet.seqno(), (unsigned short) 1);
+	QCOMPARE(packet.timestamp(), 2000UL);
+
+	unsigned long delta = 0;
+	const unsigned char *pchEvent = nullptr;
+	unsigned short nevent = 0;
+	QVERIFY(packet.read(&delta, &pchEvent, &nevent));
+	QCOMPARE(delta, 600UL);
+	QCOMPARE(pchEvent[0], (unsigned char) 0x90);
+	QVERIFY(packet.read(&delta, &pchEvent, &nevent));
+	QCOMPARE(delta, 400UL);
+	QCOMPARE(pchEvent[0], (unsigned char) 0x90);
+	QVERIFY(!packet.read(&delta, &pchEvent, &nevent));
+}
+
+
+// UMP datagrams keep their port.
+void qmidinetFilterTest::filterUmp (void)
+{
+	qmidinetFilter filter;
+	QVERIFY(filter.compile(QStringList() << "types=sensing"));
+
+	const unsigned char sensing[] = { 0xfe };
+	const unsigned char note[] = { 0x90, 0x3c, 0x64 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Ump, 2);
+	writer.write(0, sensing, sizeof(sensing));
+	writer.write(0, note, sizeof(note));
+
+	unsigned char buf[qmidinetFilter::MaxSize];
+	unsigned short len = writer.length();
+	const unsigned char *pchData = filter.filter(writer.data(), &len, 2, In, buf);
+	QVERIFY(pchData == buf);
+
+	qmidinetUdpPacketReader packet(pchData, len);
+	QVERIFY(packet.format() == qmidinetUdpPacket::Ump);
+	QCOMPARE(packet.port(), (unsigned char) 2);
+
+	unsigned long delta = 0;
+	const unsigned char *pchEvent = nullptr;
+	unsigned short nevent = 0;
+	QVERIFY(packet.read(&delta, &pchEvent, &nevent));
+	QCOMPARE(nevent, (unsigned short) 3);
+	QCOMPARE(pchEvent[0], (unsigned char) 0x90);
+	QVERIFY(!packet.read(&delta, &pchEvent, &nevent));
+}
+
+
+QTEST_APPLESS_MAIN(qmidinetFilterTest)
+
+#include "qmidinetFilterTest.moc"
+
+// end of qmidinetFilterTest.cpp
@@ -0,0 +1,184 @@
+// qmidinetSchedulerTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetScheduler.h"
+
+#include <QtTest>
+
+
+//----------------------------------------------------------------------------
+// qmidinetSchedulerTest -- Fair multi-source merge scheduler tests.
+
+class qmidinetSchedulerTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	void validPriorities();
+	void queueFull();
+	void weightedRoundRobin();
+	void sysexHold();
+	void sysexHoldExpiry();
+};
+
+
+// Sender addresses (IPv4).
+static const unsigned char g_addr1[4] = { 10, 0, 0, 1 };
+static const unsigned char g_addr2[4] = { 10, 0, 0, 2 };
+
+
+// All datagrams dequeued from a port, as hex, one per brackets.
+static QByteArray qmidinetSchedulerTest_drain (
+	qmidinetScheduler& scheduler, int port )
+{
+	QByteArray ret;
+
+	unsigned char data[qmidinetUdpPacket::MaxSize];
+	unsigned short len = 0;
+	while (scheduler.dequeue(port, data, &len)) {
+		ret += '[';
+		ret += QByteArray((const char *) data, len).toHex();
+		ret += ']';
+	}
+
+	return ret;
+}
+
+
+// Textual priorities validator.
+void qmidinetSchedulerTest::validPriorities (void)
+{
+	QVERIFY(qmidinetScheduler::isValid(QStringList()));
+	QVERIFY(qmidinetScheduler::isValid(QStringList() << "10.0.0.2=3"));
+#if defined(CONFIG_IPV6)
+	QVERIFY(qmidinetScheduler::isValid(QStringList() << "fe80::1=16"));
+#endif
+
+	QVERIFY(!qmidinetScheduler::isValid(QStringList() << "10.0.0=1"));
+	QVERIFY(!qmidinetScheduler::isValid(QStringList() << "10.0.0.2=0"));
+	QVERIFY(!qmidinetScheduler::isValid(QStringList() << "10.0.0.2=17"));
+	QVERIFY(!qmidinetScheduler::isValid(QStringList() << "10.0.0.2"));
+}
+
+
+// Excess datagrams from a chatty source are dropped, not the others'.
+void qmidinetSchedulerTest::queueFull (void)
+{
+	qmidinetScheduler scheduler;
+	scheduler.setup(1);
+
+	const unsigned char note[] = { 0x90, 0x3c, 0x64 };
+	for (int i = 0; i < qmidinetScheduler::QueueSize; ++i)
+		QVERIFY(scheduler.enqueue(0, g_addr1, 4, 5004, note, sizeof(note)));
+	QVERIFY(scheduler.isFull(0));
+	QVERIFY(!scheduler.enqueue(0, g_addr1, 4, 5004, note, sizeof(note)));
+	QVERIFY(scheduler.enqueue(0, g_addr2, 4, 5004, note, sizeof(note)));
+
+	unsigned char data[qmidinetUdpPacket::MaxSize];
+	unsigned short len = 0;
+	int n = 0;
+	while (scheduler.dequeue(0, data, &len))
+		++n;
+	QCOMPARE(n, qmidinetScheduler::QueueSize + 1);
+	QVERIFY(!scheduler.isFull(0));
+}
+
+
+// Each source gets as many datagrams per turn as its priority.
+void qmidinetSchedulerTest::weightedRoundRobin (void)
+{
+	qmidinetScheduler scheduler;
+	scheduler.setPriorities(QStringList() << "10.0.0.2=3");
+	scheduler.setup(1);
+
+	for (int i = 0; i < qmidinetScheduler::QueueSize; ++i) {
+		const unsigned char note_on[] = { 0x90, (unsigned char) i, 0x01 };
+		const unsigned char note_off[] = { 0x80, (unsigned char) i, 0x01 };
+		QVERIFY(scheduler.enqueue(0, g_addr1, 4, 5004, note_on, sizeof(note_on)));
+		QVERIFY(scheduler.enqueue(0, g_addr2, 4, 5004, note_off, sizeof(note_off)));
+	}
+
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0),
+		QByteArray("[800001][800101][800201][900001][800301][900101][900201][900301]"));
+}
+
+
+// A source with an open SysEx keeps its turn until it's over.
+void qmidinetSchedulerTest::sysexHold (void)
+{
+	qmidinetScheduler scheduler;
+	scheduler.setup(1);
+
+	const unsigned char sysex1[] = { 0xf0, 0x7e, 0x01 };
+	const unsigned char sysex2[] = { 0x02, 0xf7 };
+	const unsigned char note[] = { 0x90, 0x40, 0x40 };
+
+	QVERIFY(scheduler.enqueue(0, g_addr1, 4, 5004, sysex1, sizeof(sysex1)));
+	QVERIFY(scheduler.enqueue(0, g_addr2, 4, 5004, note, sizeof(note)));
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0),
+		QByteArray("[904040][f07e01]"));
+	QVERIFY(scheduler.isHolding(0));
+	QVERIFY(scheduler.isHolding());
+
+	// Nothing gets spliced in...
+	QVERIFY(scheduler.enqueue(0, g_addr2, 4, 5004, note, sizeof(note)));
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0), QByteArray());
+	QVERIFY(scheduler.isHolding(0));
+
+	// ...until the SysEx is over.
+	QVERIFY(scheduler.enqueue(0, g_addr1, 4, 5004, sysex2, sizeof(sysex2)));
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0),
+		QByteArray("[02f7][904040]"));
+	QVERIFY(!scheduler.isHolding(0));
+}
+
+
+// A stalled open SysEx is given up after the hold time.
+void qmidinetSchedulerTest::sysexHoldExpiry (void)
+{
+	qmidinetScheduler scheduler;
+	scheduler.setup(1);
+
+	const unsigned char sysex1[] = { 0xf0, 0x7e, 0x01 };
+	const unsigned char note[] = { 0x90, 0x40, 0x40 };
+
+	QVERIFY(scheduler.enqueue(0, g_addr1, 4, 5004, sysex1, sizeof(sysex1)));
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0),
+		QByteArray("[f07e01]"));
+	QVERIFY(scheduler.isHolding(0));
+
+	QVERIFY(scheduler.enqueue(0, g_addr2, 4, 5004, note, sizeof(note)));
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0), QByteArray());
+
+	QTest::qSleep(qmidinetScheduler::HoldTime + 10);
+
+	QCOMPARE(qmidinetSchedulerTest_drain(scheduler, 0),
+		QByteArray("[904040]"));
+	QVERIFY(!scheduler.isHolding(0));
+}
+
+
+QTEST_APPLESS_MAIN(qmidinetSchedulerTest)
+
+#include "qmidinetSchedulerTest.moc"
+
+// end of qmidinetSchedulerTest.cpp
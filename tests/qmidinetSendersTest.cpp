@@ -0,0 +1,164 @@
+// qmidinetSendersTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetSenders.h"
+
+#include <QtTest>
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetSendersTest -- Per-sender stream state tests.
+
+class qmidinetSendersTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	void rawRunningStatus();
+	void rawSysexInterleaved();
+	void rawPerPort();
+	void timedSequence();
+};
+
+
+// Sender addresses (IPv4-mapped).
+static const unsigned char g_addr1[16]
+	= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 10, 0, 0, 1 };
+static const unsigned char g_addr2[16]
+	= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 10, 0, 0, 2 };
+
+
+// A processed datagram, as hex.
+static QByteArray qmidinetSendersTest_process (
+	qmidinetSenders& senders, int port, const unsigned char *addr,
+	const unsigned char *in, unsigned short len )
+{
+	unsigned char data[qmidinetSenders::MaxSize];
+	const unsigned short n = senders.process(port, addr, 5004, in, len, data);
+	return QByteArray((const char *) data, n).toHex();
+}
+
+
+// Partial messages and running status carry over to the next datagram.
+void qmidinetSendersTest::rawRunningStatus (void)
+{
+	qmidinetSenders senders;
+	senders.setup();
+
+	const unsigned char data1[] = { 0x90, 0x3c, 0x40, 0x3e };
+	const unsigned char data2[] = { 0x40, 0x40, 0x00, 0xf8 };
+
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		data1, sizeof(data1)), QByteArray("903c40"));
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		data2, sizeof(data2)), QByteArray("903e40904000f8"));
+	QCOMPARE(senders.count(), 1);
+}
+
+
+// SysEx gets reassembled per sender, others interleaving.
+void qmidinetSendersTest::rawSysexInterleaved (void)
+{
+	qmidinetSenders senders;
+	senders.setup();
+
+	const unsigned char a1[] = { 0x90, 0x3c, 0x40, 0x3e };
+	const unsigned char b1[] = { 0xf0, 0x7e, 0x01 };
+	const unsigned char a2[] = { 0x40, 0x40, 0x00, 0xf8 };
+	const unsigned char b2[] = { 0x02, 0xf8, 0x03, 0xf7, 0xc0, 0x05 };
+
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		a1, sizeof(a1)), QByteArray("903c40"));
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr2,
+		b1, sizeof(b1)), QByteArray());
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		a2, sizeof(a2)), QByteArray("903e40904000f8"));
+
+	// Real-time messages go through, right away...
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr2,
+		b2, sizeof(b2)), QByteArray("f8f07e010203f7c005"));
+	QCOMPARE(senders.count(), 2);
+}
+
+
+// The same sender on another port is another stream.
+void qmidinetSendersTest::rawPerPort (void)
+{
+	qmidinetSenders senders;
+	senders.setup();
+
+	const unsigned char data1[] = { 0x90, 0x3c };
+	const unsigned char data2[] = { 0x40 };
+
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		data1, sizeof(data1)), QByteArray());
+	QCOMPARE(qmidinetSendersTest_process(senders, 1, g_addr1,
+		data2, sizeof(data2)), QByteArray());
+	QCOMPARE(qmidinetSendersTest_process(senders, 0, g_addr1,
+		data2, sizeof(data2)), QByteArray("903c40"));
+	QCOMPARE(senders.count(), 2);
+}
+
+
+// Time-stamped datagrams: lost ones counted, duplicates dropped.
+void qmidinetSendersTest::timedSequence (void)
+{
+	qmidinetSenders senders;
+	senders.setup();
+
+	const unsigned char note[] = { 0x90, 0x01, 0x01 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Timed);
+
+	QByteArray dgrams[5];
+	for (int k = 0; k < 5; ++k) {
+		writer.clear();
+		QVERIFY(writer.write(0, note, sizeof(note)));
+		dgrams[k] = QByteArray((const char *) writer.data(), writer.length());
+	}
+
+	// Out of order, but none lost...
+	const int seqnos[] = { 0, 2, 2, 1, 4, 3, 0 };
+	const bool dups[]  = { false, false, true, false, false, false, true };
+
+	unsigned char data[qmidinetSenders::MaxSize];
+	for (unsigned int i = 0; i < sizeof(seqnos) / sizeof(int); ++i) {
+		const QByteArray& dgram = dgrams[seqnos[i]];
+		const unsigned short n = senders.process(0, g_addr1, 5004,
+			(const unsigned char *) dgram.constData(), dgram.size(), data);
+		QCOMPARE(n, (unsigned short) (dups[i] ? 0 : dgram.size()));
+	}
+
+	QCOMPARE(senders.lost(), 0UL);
+	QCOMPARE(senders.duplicates(), 2UL);
+	QCOMPARE(senders.count(), 1);
+}
+
+
+QTEST_APPLESS_MAIN(qmidinetSendersTest)
+
+#include "qmidinetSendersTest.moc"
+
+// end of qmidinetSendersTest.cpp
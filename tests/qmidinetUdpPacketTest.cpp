@@ -0,0 +1,208 @@
+// qmidinetUdpPacketTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetUdpPacket.h"
+
+#include <QtTest>
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetUdpPacketTest -- Datagram reader and writer tests.
+
+class qmidinetUdpPacketTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	void rawRunningStatus();
+	void rawRealtimeWithin();
+	void rawSysexContinuation();
+	void rawSysexOpen();
+	void rawStrayData();
+	void timedWriteRead();
+	void timedBegin();
+	void umpWriteRead();
+};
+
+
+// All messages read from a datagram, as hex, one per brackets.
+static QByteArray qmidinetUdpPacketTest_dump (
+	const unsigned char *data, unsigned short len )
+{
+	QByteArray ret;
+
+	qmidinetUdpPacketReader packet(data, len);
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short nlen = 0;
+	while (packet.read(&delta, &pchData, &nlen)) {
+		ret += '[';
+		ret += QByteArray((const char *) pchData, nlen).toHex();
+		ret += ']';
+	}
+
+	return ret;
+}
+
+
+// Raw datagrams: running status gets restored.
+void qmidinetUdpPacketTest::rawRunningStatus (void)
+{
+	const unsigned char data[] = { 0x90, 0x3c, 0x64, 0x3e, 0x40, 0xc0, 0x05, 0x06 };
+
+	QVERIFY(qmidinetUdpPacket::format(data, sizeof(data))
+		== qmidinetUdpPacket::Raw);
+	QCOMPARE(qmidinetUdpPacketTest_dump(data, sizeof(data)),
+		QByteArray("[903c64][903e40][c005][c006]"));
+}
+
+
+// Raw datagrams: real-time messages go through, anywhere.
+void qmidinetUdpPacketTest::rawRealtimeWithin (void)
+{
+	const unsigned char data[] = { 0x90, 0x3c, 0xf8, 0x64, 0x3e, 0x40 };
+
+	QCOMPARE(qmidinetUdpPacketTest_dump(data, sizeof(data)),
+		QByteArray("[f8][903c64][903e40]"));
+}
+
+
+// Raw datagrams: leading data bytes are a SysEx continuation.
+void qmidinetUdpPacketTest::rawSysexContinuation (void)
+{
+	const unsigned char data[] = { 0x01, 0x02, 0x03, 0xf7, 0x80, 0x3c, 0x00 };
+
+	QCOMPARE(qmidinetUdpPacketTest_dump(data, sizeof(data)),
+		QByteArray("[010203f7][803c00]"));
+}
+
+
+// Raw datagrams: SysEx left open goes up to the datagram's end.
+void qmidinetUdpPacketTest::rawSysexOpen (void)
+{
+	const unsigned char data[] = { 0xc0, 0x05, 0xf0, 0x7e, 0xf7, 0xf0, 0x01, 0x02 };
+
+	QCOMPARE(qmidinetUdpPacketTest_dump(data, sizeof(data)),
+		QByteArray("[c005][f07ef7][f00102]"));
+}
+
+
+// Raw datagrams: data bytes with no status are skipped.
+void qmidinetUdpPacketTest::rawStrayData (void)
+{
+	const unsigned char data[] = { 0xf6, 0x01, 0x02, 0x90, 0x3c };
+
+	QCOMPARE(qmidinetUdpPacketTest_dump(data, sizeof(data)),
+		QByteArray("[f6]"));
+}
+
+
+// Time-stamped datagrams: header, delta times and sequence numbers.
+void qmidinetUdpPacketTest::timedWriteRead (void)
+{
+	const unsigned char note[] = { 0x90, 0x3c, 0x64 };
+	const unsigned char clock[] = { 0xf8 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Timed);
+	QVERIFY(writer.isEmpty());
+	QVERIFY(writer.write(1000, clock, sizeof(clock)));
+	QVERIFY(writer.write(1500, note, sizeof(note)));
+	QCOMPARE(writer.count(), 2);
+
+	qmidinetUdpPacketReader packet(writer.data(), writer.length());
+	QVERIFY(packet.format() == qmidinetUdpPacket::Timed);
+	QCOMPARE(packet.seqno(), (unsigned short) 0);
+	QCOMPARE(packet.timestamp(), 1000UL);
+
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short len = 0;
+	QVERIFY(packet.read(&delta, &pchData, &len));
+	QCOMPARE(delta, 0UL);
+	QCOMPARE(len, (unsigned short) 1);
+	QCOMPARE(pchData[0], (unsigned char) 0xf8);
+	QVERIFY(packet.read(&delta, &pchData, &len));
+	QCOMPARE(delta, 500UL);
+	QCOMPARE(len, (unsigned short) 3);
+	QVERIFY(::memcmp(pchData, note, len) == 0);
+	QVERIFY(!packet.read(&delta, &pchData, &len));
+
+	// Next datagram gets the next sequence number...
+	writer.clear();
+	QVERIFY(writer.write(2000, clock, sizeof(clock)));
+	qmidinetUdpPacketReader packet2(writer.data(), writer.length());
+	QCOMPARE(packet2.seqno(), (unsigned short) 1);
+	QCOMPARE(packet2.timestamp(), 2000UL);
+}
+
+
+// Time-stamped datagrams: rewritten with the original header.
+void qmidinetUdpPacketTest::timedBegin (void)
+{
+	const unsigned char note[] = { 0x90, 0x3c, 0x64 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Timed);
+	writer.begin(7, 2000);
+	QVERIFY(writer.isEmpty());
+	QVERIFY(writer.write(2600, note, sizeof(note)));
+
+	qmidinetUdpPacketReader packet(writer.data(), writer.length());
+	QCOMPARE(packet.seqno(), (unsigned short) 7);
+	QCOMPARE(packet.timestamp(), 2000UL);
+
+	unsigned long delta = 0;
+	const unsigned char *pchData = nullptr;
+	unsigned short len = 0;
+	QVERIFY(packet.read(&delta, &pchData, &len));
+	QCOMPARE(delta, 600UL);
+	QCOMPARE(len, (unsigned short) 3);
+}
+
+
+// UMP datagrams: port number and MIDI 1.0 translation.
+void qmidinetUdpPacketTest::umpWriteRead (void)
+{
+	const unsigned char note[] = { 0x91, 0x3c, 0x64 };
+	const unsigned char sysex[] = { 0xf0, 0x7e, 0x01, 0xf7 };
+
+	qmidinetUdpPacketWriter writer;
+	writer.setFormat(qmidinetUdpPacket::Ump, 3);
+	QVERIFY(writer.write(0, note, sizeof(note)));
+	QVERIFY(writer.write(0, sysex, sizeof(sysex)));
+
+	qmidinetUdpPacketReader packet(writer.data(), writer.length());
+	QVERIFY(packet.format() == qmidinetUdpPacket::Ump);
+	QCOMPARE(packet.port(), (unsigned char) 3);
+	QCOMPARE(qmidinetUdpPacketTest_dump(writer.data(), writer.length()),
+		QByteArray("[913c64][f07e01f7]"));
+}
+
+
+QTEST_APPLESS_MAIN(qmidinetUdpPacketTest)
+
+#include "qmidinetUdpPacketTest.moc"
+
+// end of qmidinetUdpPacketTest.cpp
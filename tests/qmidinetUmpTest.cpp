@@ -0,0 +1,231 @@
+// qmidinetUmpTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2010-2026, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qmidinetUmp.h"
+
+#include <QtTest>
+
+#include <string.h>
+
+
+//----------------------------------------------------------------------------
+// qmidinetUmpTest -- MIDI 2.0 Universal MIDI Packet (UMP) tests.
+
+class qmidinetUmpTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	void channelVoice();
+	void system();
+	void sysex7Complete();
+	void sysex7MultiPacket();
+	void sysex7Continuation();
+	void midi2Downscale();
+};
+
+
+// All packets decoded, as hex, one per brackets.
+static QByteArray qmidinetUmpTest_decode (
+	const unsigned int *ump, unsigned short nwords )
+{
+	QByteArray ret;
+
+	unsigned short i = 0;
+	while (i < nwords) {
+		unsigned char data[qmidinetUmp::MaxDecodeSize];
+		const unsigned short len = qmidinetUmp::decode(&ump[i], data);
+		ret += '[';
+		ret += QByteArray((const char *) data, len).toHex();
+		ret += ']';
+		i += qmidinetUmp::packetSize(ump[i]);
+	}
+
+	return ret;
+}
+
+
+// One packet at a time, as all at once.
+static unsigned short qmidinetUmpTest_encodeNext (
+	const unsigned char *data, unsigned short len,
+	unsigned char group, unsigned int *ump )
+{
+	unsigned short nwords = 0;
+	unsigned short i = 0;
+	while (i < len) {
+		unsigned short n = 0;
+		const unsigned short nsize
+			= qmidinetUmp::encodeNext(data + i, len - i, group, ump + nwords, &n);
+		if (nsize < 1 || nsize > qmidinetUmp::MaxWords)
+			return 0;
+		nwords += nsize;
+		i += n;
+	}
+
+	return nwords;
+}
+
+
+// MIDI 1.0 channel voice messages, on some group.
+void qmidinetUmpTest::channelVoice (void)
+{
+	const unsigned char note[] = { 0x93, 0x3c, 0x64 };
+	const unsigned char program[] = { 0xc5, 0x07 };
+
+	unsigned int ump[qmidinetUmp::MaxWords];
+	QCOMPARE(qmidinetUmp::encode(note, sizeof(note), 2, ump), (unsigned short) 1);
+	QCOMPARE(ump[0], 0x22933c64U);
+	QCOMPARE(qmidinetUmp::packetSize(ump[0]), (unsigned short) 1);
+	QCOMPARE(qmidinetUmp::group(ump[0]), (unsigned char) 2);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 1), QByteArray("[933c64]"));
+
+	QCOMPARE(qmidinetUmp::encode(program, sizeof(program), 0, ump), (unsigned short) 1);
+	QCOMPARE(ump[0], 0x20c50700U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 1), QByteArray("[c507]"));
+
+	// Incomplete ones are undefined...
+	QCOMPARE(qmidinetUmp::encode(note, 2, 0, ump), (unsigned short) 0);
+}
+
+
+// System common and real-time messages.
+void qmidinetUmpTest::system (void)
+{
+	const unsigned char clock[] = { 0xf8 };
+	const unsigned char song[] = { 0xf2, 0x10, 0x20 };
+
+	unsigned int ump[qmidinetUmp::MaxWords];
+	QCOMPARE(qmidinetUmp::encode(clock, sizeof(clock), 1, ump), (unsigned short) 1);
+	QCOMPARE(ump[0], 0x11f80000U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 1), QByteArray("[f8]"));
+
+	QCOMPARE(qmidinetUmp::encode(song, sizeof(song), 0, ump), (unsigned short) 1);
+	QCOMPARE(ump[0], 0x10f21020U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 1), QByteArray("[f21020]"));
+}
+
+
+// Short SysEx, in one single packet.
+void qmidinetUmpTest::sysex7Complete (void)
+{
+	const unsigned char sysex[] = { 0xf0, 0x7e, 0x01, 0xf7 };
+
+	unsigned int ump[qmidinetUmp::MaxWords];
+	QCOMPARE(qmidinetUmp::encode(sysex, sizeof(sysex), 0, ump), (unsigned short) 2);
+	QCOMPARE(ump[0], 0x30027e01U);
+	QCOMPARE(ump[1], 0x00000000U);
+	QCOMPARE(qmidinetUmp::packetSize(ump[0]), (unsigned short) 2);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[f07e01f7]"));
+}
+
+
+// Longer SysEx, split in start, continue and end packets.
+void qmidinetUmpTest::sysex7MultiPacket (void)
+{
+	unsigned char sysex[15];
+	sysex[0] = 0xf0;
+	for (int i = 1; i < 14; ++i)
+		sysex[i] = i;
+	sysex[14] = 0xf7;
+
+	unsigned int ump[16];
+	QCOMPARE(qmidinetUmp::encodeSize(sizeof(sysex)), (unsigned short) 6);
+	const unsigned short nwords
+		= qmidinetUmp::encode(sysex, sizeof(sysex), 0, ump);
+	QCOMPARE(nwords, (unsigned short) 6);
+	QCOMPARE(ump[0], 0x30160102U);	// Start, 6 bytes.
+	QCOMPARE(ump[1], 0x03040506U);
+	QCOMPARE(ump[2], 0x30260708U);	// Continue, 6 bytes.
+	QCOMPARE(ump[3], 0x090a0b0cU);
+	QCOMPARE(ump[4], 0x30310d00U);	// End, 1 byte.
+	QCOMPARE(ump[5], 0x00000000U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, nwords),
+		QByteArray("[f0010203040506][0708090a0b0c][0df7]"));
+
+	// One packet at a time, the very same...
+	unsigned int ump2[16];
+	QCOMPARE(qmidinetUmpTest_encodeNext(sysex, sizeof(sysex), 0, ump2), nwords);
+	QVERIFY(::memcmp(ump, ump2, nwords * sizeof(unsigned int)) == 0);
+}
+
+
+// SysEx chunks (eg. split across datagrams).
+void qmidinetUmpTest::sysex7Continuation (void)
+{
+	const unsigned char head[] = { 0xf0, 0x01, 0x02 };
+	const unsigned char body[] = { 0x03, 0x04 };
+	const unsigned char tail[] = { 0x05, 0xf7 };
+
+	unsigned int ump[qmidinetUmp::MaxWords];
+	QCOMPARE(qmidinetUmp::encode(head, sizeof(head), 0, ump), (unsigned short) 2);
+	QCOMPARE(ump[0], 0x30120102U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[f00102]"));
+
+	QCOMPARE(qmidinetUmp::encode(body, sizeof(body), 0, ump), (unsigned short) 2);
+	QCOMPARE(ump[0], 0x30220304U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[0304]"));
+
+	QCOMPARE(qmidinetUmp::encode(tail, sizeof(tail), 0, ump), (unsigned short) 2);
+	QCOMPARE(ump[0], 0x30310500U);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[05f7]"));
+}
+
+
+// MIDI 2.0 channel voice, scaled down to MIDI 1.0.
+void qmidinetUmpTest::midi2Downscale (void)
+{
+	unsigned int ump[2];
+
+	// Note on, full velocity...
+	ump[0] = 0x41913c00U;
+	ump[1] = 0xffff0000U;
+	QCOMPARE(qmidinetUmp::packetSize(ump[0]), (unsigned short) 2);
+	QCOMPARE(qmidinetUmp::group(ump[0]), (unsigned char) 1);
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[913c7f]"));
+
+	// Note on, tiny velocity (never a note off)...
+	ump[1] = 0x00010000U;
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[913c01]"));
+
+	// Controller, half-way...
+	ump[0] = 0x40b00700U;
+	ump[1] = 0x80000000U;
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[b00740]"));
+
+	// Pitch bend, centered...
+	ump[0] = 0x40e00000U;
+	ump[1] = 0x80000000U;
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2), QByteArray("[e00040]"));
+
+	// Registered parameter, as 14-bit (N)RPN controllers...
+	ump[0] = 0x40200001U;
+	ump[1] = 0x80000000U;
+	QCOMPARE(qmidinetUmpTest_decode(ump, 2),
+		QByteArray("[b06500b06401b00640b02600]"));
+}
+
+
+QTEST_APPLESS_MAIN(qmidinetUmpTest)
+
+#include "qmidinetUmpTest.moc"
+
+// end of qmidinetUmpTest.cpp